@@ -0,0 +1,10 @@
+#ifndef LAB0_CACHELINE_H
+#define LAB0_CACHELINE_H
+
+/* Assumed size of a cache line. Fields written by different threads are kept
+ * at least this far apart, so that the threads do not keep taking the line
+ * away from each other.
+ */
+#define CACHE_LINE_SIZE 64
+
+#endif /* LAB0_CACHELINE_H */
@@ -326,8 +326,11 @@ static bool do_option(int argc, char *argv[])
             if (strcmp(plist->name, name) == 0) {
                 int oldval = *plist->valp;
                 *plist->valp = value;
-                if (plist->setter)
+                if (plist->setter) {
                     plist->setter(oldval);
+                    if (*plist->valp != value)
+                        return false;
+                }
                 found = true;
             } else
                 plist = plist->next;
@@ -391,6 +394,21 @@ static bool do_time(int argc, char *argv[])
     return ok;
 }
 
+static bool do_repeat(int argc, char *argv[])
+{
+    int count = 0;
+    if (argc < 3 || !get_int(argv[1], &count) || count < 0) {
+        report(1, "%s takes a count and a command", argv[0]);
+        return false;
+    }
+
+    bool ok = true;
+    for (int i = 0; ok && i < count; i++)
+        ok = interpret_cmda(argc - 2, argv + 2);
+
+    return ok;
+}
+
 static bool use_linenoise = true;
 static int web_fd;
 
@@ -429,6 +447,7 @@ void init_cmd()
     ADD_COMMAND(quit, "Exit program", "");
     ADD_COMMAND(source, "Read commands from source file", "");
     ADD_COMMAND(log, "Copy output to file", "file");
+    ADD_COMMAND(repeat, "Run command count times", "count cmd arg ...");
     ADD_COMMAND(time, "Time command execution", "cmd arg ...");
     ADD_COMMAND(web, "Read commands from builtin web server", "[port]");
     add_cmd("#", do_comment_cmd, "Display comment", "...");
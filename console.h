@@ -27,7 +27,8 @@ typedef struct __cmd_element {
     struct __cmd_element *next;
 } cmd_element_t;
 
-/* Optionally supply function that gets invoked when parameter changes */
+/* Optionally supply function that gets invoked when parameter changes. It may
+ * reject the new value by restoring oldval, which fails the option command. */
 typedef void (*setter_func_t)(int oldval);
 
 /* Integer-valued parameters */
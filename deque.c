@@ -0,0 +1,184 @@
+#include "deque.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Get the slot at position @i from the head */
+static inline deque_slot_t *deque_slot(const deque_t *d, size_t i)
+{
+    return &d->slots[(d->head + i) & (d->capacity - 1)];
+}
+
+static inline const char *slot_string(const deque_slot_t *slot)
+{
+    return slot->value ? slot->value : slot->inline_value;
+}
+
+/* Copy @s into @slot, allocating it only if it is too long to be inline */
+static bool slot_store(deque_slot_t *slot, const char *s)
+{
+    size_t len = strlen(s) + 1;
+    char *value = slot->inline_value;
+    if (len > sizeof(slot->inline_value)) {
+        value = malloc(len);
+        if (value == NULL) {
+            return false;
+        }
+    }
+
+    memcpy(value, s, len);
+    slot->value = value == slot->inline_value ? NULL : value;
+    return true;
+}
+
+/* Copy the string of @slot to @sp like q_remove_head() does, and free it */
+static void slot_take(deque_slot_t *slot, char *sp, size_t bufsize)
+{
+    if (sp != NULL) {
+        strncpy(sp, slot_string(slot), bufsize - 1);
+        sp[bufsize - 1] = '\0';
+    }
+    free(slot->value);
+}
+
+/* Move the strings to a new array of @capacity slots, starting at index 0 */
+static bool deque_resize(deque_t *d, size_t capacity)
+{
+    deque_slot_t *slots = malloc(sizeof(deque_slot_t) * capacity);
+    if (slots == NULL) {
+        return false;
+    }
+
+    size_t first = d->capacity - d->head;
+    if (first > d->size) {
+        first = d->size;
+    }
+    memcpy(slots, &d->slots[d->head], sizeof(deque_slot_t) * first);
+    memcpy(&slots[first], d->slots, sizeof(deque_slot_t) * (d->size - first));
+
+    free(d->slots);
+    d->slots = slots;
+    d->capacity = capacity;
+    d->head = 0;
+    return true;
+}
+
+/* Halve the array once it is a quarter full. Failing to is harmless, the
+ * array is only larger than needed. */
+static void deque_shrink(deque_t *d)
+{
+    if (d->capacity > DEQUE_MIN_CAPACITY && d->size < d->capacity / 4) {
+        deque_resize(d, d->capacity / 2);
+    }
+}
+
+/* Initialize an empty deque */
+bool deque_init(deque_t *d)
+{
+    d->slots = malloc(sizeof(deque_slot_t) * DEQUE_MIN_CAPACITY);
+    if (d->slots == NULL) {
+        return false;
+    }
+
+    d->capacity = DEQUE_MIN_CAPACITY;
+    d->head = 0;
+    d->size = 0;
+    return true;
+}
+
+/* Free all storage used by deque */
+void deque_free(deque_t *d)
+{
+    for (size_t i = 0; i < d->size; i++) {
+        free(deque_slot(d, i)->value);
+    }
+    free(d->slots);
+    d->slots = NULL;
+    d->capacity = d->size = 0;
+}
+
+/* Insert a copy of a string at the head */
+bool deque_insert_head(deque_t *d, const char *s)
+{
+    if (d->size == d->capacity && !deque_resize(d, 2 * d->capacity)) {
+        return false;
+    }
+
+    size_t head = (d->head - 1) & (d->capacity - 1);
+    if (!slot_store(&d->slots[head], s)) {
+        return false;
+    }
+
+    d->head = head;
+    d->size++;
+    return true;
+}
+
+/* Insert a copy of a string at the tail */
+bool deque_insert_tail(deque_t *d, const char *s)
+{
+    if (d->size == d->capacity && !deque_resize(d, 2 * d->capacity)) {
+        return false;
+    }
+
+    if (!slot_store(deque_slot(d, d->size), s)) {
+        return false;
+    }
+
+    d->size++;
+    return true;
+}
+
+/* Remove the string at the head */
+bool deque_remove_head(deque_t *d, char *sp, size_t bufsize)
+{
+    if (d->size == 0) {
+        return false;
+    }
+
+    slot_take(&d->slots[d->head], sp, bufsize);
+    d->head = (d->head + 1) & (d->capacity - 1);
+    d->size--;
+    deque_shrink(d);
+    return true;
+}
+
+/* Remove the string at the tail */
+bool deque_remove_tail(deque_t *d, char *sp, size_t bufsize)
+{
+    if (d->size == 0) {
+        return false;
+    }
+
+    slot_take(deque_slot(d, d->size - 1), sp, bufsize);
+    d->size--;
+    deque_shrink(d);
+    return true;
+}
+
+/* Move every string to the tail of a queue */
+bool deque_to_queue(deque_t *d, struct list_head *head)
+{
+    while (d->size > 0) {
+        /* q_insert_tail() takes a mutable string, though it only copies it */
+        if (!q_insert_tail(head, (char *) slot_string(&d->slots[d->head]))) {
+            return false;
+        }
+        deque_remove_head(d, NULL, 0);
+    }
+
+    return true;
+}
+
+/* Move every string of a queue to the tail */
+bool deque_from_queue(deque_t *d, struct list_head *head)
+{
+    while (!list_empty(head)) {
+        const element_t *first = list_first_entry(head, element_t, list);
+        if (!deque_insert_tail(d, first->value)) {
+            return false;
+        }
+        q_release_element(q_remove_head(head, NULL, 0));
+    }
+
+    return true;
+}
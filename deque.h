@@ -0,0 +1,126 @@
+#ifndef LAB0_DEQUE_H
+#define LAB0_DEQUE_H
+
+/* This program implements a double-ended queue of strings in a growable
+ * circular array, for workloads which only insert and remove at either end.
+ *
+ * Strings which fit are stored in the slots themselves, so such workloads
+ * neither allocate per string nor chase pointers. Operations a circular array
+ * is poor at, e.g. q_merge() or q_reverseK(), are served by moving the strings
+ * to a queue and back.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "queue.h"
+
+/* Smallest capacity of a deque, which is never shrunk below it */
+#define DEQUE_MIN_CAPACITY 16
+
+/**
+ * deque_slot_t - A slot of a deque
+ * @value: pointer to the allocated string, NULL if stored in @inline_value
+ * @inline_value: storage for short strings
+ *
+ * Slots are moved when the array is resized, so a short string is not pointed
+ * to from its own slot.
+ */
+typedef struct {
+    char *value;
+    char inline_value[ELEMENT_INLINE_SIZE];
+} deque_slot_t;
+
+/**
+ * deque_t - Double-ended queue in a circular array
+ * @slots: array of @capacity slots
+ * @capacity: the number of slots, a power of two
+ * @head: index of the slot holding the first string
+ * @size: the number of strings
+ *
+ * The array doubles when it is full and halves when it is a quarter full, so
+ * insertions and removals at either end take amortized constant time.
+ */
+typedef struct {
+    deque_slot_t *slots;
+    size_t capacity;
+    size_t head;
+    size_t size;
+} deque_t;
+
+/**
+ * deque_init() - Initialize an empty deque
+ * @d: the deque
+ *
+ * Return: true for success, false for allocation failed
+ */
+bool deque_init(deque_t *d);
+
+/**
+ * deque_free() - Free all storage used by deque
+ * @d: the deque, which must be initialized again before being reused
+ */
+void deque_free(deque_t *d);
+
+/**
+ * deque_insert_head() - Insert a copy of a string at the head
+ * @d: the deque
+ * @s: string would be inserted
+ *
+ * Return: true for success, false for allocation failed
+ */
+bool deque_insert_head(deque_t *d, const char *s);
+
+/**
+ * deque_insert_tail() - Insert a copy of a string at the tail
+ * @d: the deque
+ * @s: string would be inserted
+ *
+ * Return: true for success, false for allocation failed
+ */
+bool deque_insert_tail(deque_t *d, const char *s);
+
+/**
+ * deque_remove_head() - Remove the string at the head
+ * @d: the deque
+ * @sp: buffer the removed string is copied to, unless NULL
+ * @bufsize: size of the buffer
+ *
+ * Like q_remove_head(), at most bufsize-1 characters are copied, plus a null
+ * terminator.
+ *
+ * Return: true for success, false if the deque is empty
+ */
+bool deque_remove_head(deque_t *d, char *sp, size_t bufsize);
+
+/**
+ * deque_remove_tail() - Remove the string at the tail
+ * @d: the deque
+ * @sp: buffer the removed string is copied to, unless NULL
+ * @bufsize: size of the buffer
+ *
+ * Return: true for success, false if the deque is empty
+ */
+bool deque_remove_tail(deque_t *d, char *sp, size_t bufsize);
+
+/**
+ * deque_to_queue() - Move every string to the tail of a queue
+ * @d: the deque
+ * @head: header of queue
+ *
+ * Return: true for success, false for allocation failed, in which case the
+ * strings not moved yet are left in @d
+ */
+bool deque_to_queue(deque_t *d, struct list_head *head);
+
+/**
+ * deque_from_queue() - Move every string of a queue to the tail
+ * @d: the deque
+ * @head: header of queue
+ *
+ * Return: true for success, false for allocation failed, in which case the
+ * strings not moved yet are left in the queue
+ */
+bool deque_from_queue(deque_t *d, struct list_head *head);
+
+#endif /* LAB0_DEQUE_H */
@@ -4,6 +4,7 @@
 
 #include "constant.h"
 #include "cpucycles.h"
+#include "deque.h"
 #include "queue.h"
 #include "random.h"
 
@@ -36,6 +37,16 @@ static struct list_head *l = NULL;
 
 #define dut_free() ((void) (q_free(l)))
 
+/* The deque measured the same way, which is reached by the ring command */
+static deque_t d;
+
+#define dut_deque_insert_tail(s, n)   \
+    do {                              \
+        int j = n;                    \
+        while (j--)                   \
+            deque_insert_tail(&d, s); \
+    } while (0)
+
 static char random_string[N_MEASURES][8];
 static int random_string_iter = 0;
 
@@ -73,7 +84,9 @@ bool measure(int64_t *before_ticks,
              int mode)
 {
     assert(mode == DUT(insert_head) || mode == DUT(insert_tail) ||
-           mode == DUT(remove_head) || mode == DUT(remove_tail));
+           mode == DUT(remove_head) || mode == DUT(remove_tail) ||
+           mode == DUT(deque_insert_head) || mode == DUT(deque_insert_tail) ||
+           mode == DUT(deque_remove_head) || mode == DUT(deque_remove_tail));
 
     switch (mode) {
     case DUT(insert_head):
@@ -146,6 +159,49 @@ bool measure(int64_t *before_ticks,
                 return false;
         }
         break;
+    case DUT(deque_insert_head):
+    case DUT(deque_insert_tail):
+        for (size_t i = DROP_SIZE; i < N_MEASURES - DROP_SIZE; i++) {
+            char *s = get_random_string();
+            if (!deque_init(&d))
+                return false;
+            dut_deque_insert_tail(
+                get_random_string(),
+                *(uint16_t *) (input_data + i * CHUNK_SIZE) % 10000);
+            size_t before_size = d.size;
+            before_ticks[i] = cpucycles();
+            if (mode == DUT(deque_insert_head))
+                deque_insert_head(&d, s);
+            else
+                deque_insert_tail(&d, s);
+            after_ticks[i] = cpucycles();
+            size_t after_size = d.size;
+            deque_free(&d);
+            if (before_size != after_size - 1)
+                return false;
+        }
+        break;
+    case DUT(deque_remove_head):
+    case DUT(deque_remove_tail):
+        for (size_t i = DROP_SIZE; i < N_MEASURES - DROP_SIZE; i++) {
+            if (!deque_init(&d))
+                return false;
+            dut_deque_insert_tail(
+                get_random_string(),
+                *(uint16_t *) (input_data + i * CHUNK_SIZE) % 10000 + 1);
+            size_t before_size = d.size;
+            before_ticks[i] = cpucycles();
+            if (mode == DUT(deque_remove_head))
+                deque_remove_head(&d, NULL, 0);
+            else
+                deque_remove_tail(&d, NULL, 0);
+            after_ticks[i] = cpucycles();
+            size_t after_size = d.size;
+            deque_free(&d);
+            if (before_size != after_size + 1)
+                return false;
+        }
+        break;
     default:
         for (size_t i = DROP_SIZE; i < N_MEASURES - DROP_SIZE; i++) {
             dut_new();
@@ -12,11 +12,15 @@
 
 #define DROP_SIZE 20
 
-#define DUT_FUNCS  \
-    _(insert_head) \
-    _(insert_tail) \
-    _(remove_head) \
-    _(remove_tail)
+#define DUT_FUNCS        \
+    _(insert_head)       \
+    _(insert_tail)       \
+    _(remove_head)       \
+    _(remove_tail)       \
+    _(deque_insert_head) \
+    _(deque_insert_tail) \
+    _(deque_remove_head) \
+    _(deque_remove_tail)
 
 #define DUT(x) DUT_##x
 
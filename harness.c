@@ -1,11 +1,15 @@
 /* Test support code */
 
+#include <pthread.h>
 #include <setjmp.h>
 #include <signal.h>
+#include <stdatomic.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
 #include "report.h"
@@ -30,29 +34,116 @@
 
 /* Data structures used by our code */
 
-/* Represent allocated blocks as doubly-linked list, with
- * next and prev pointers at beginning
+/* Represent allocated blocks by a header in front of the payload. The header
+ * of a block in guard mode may be misaligned, hence packed.
  */
-typedef struct __block_element {
-    struct __block_element *next, *prev;
+typedef struct __attribute__((packed)) __block_element {
     size_t payload_size;
-    size_t magic_header; /* Marker to see if block seems legitimate */
+    uint32_t size_class;   /* 1 + size class of the slab holding the block,
+                            * GUARD_CLASS if the block has pages of its own,
+                            * 0 if the block came from malloc */
+    uint32_t magic_header; /* Marker to see if block seems legitimate */
     unsigned char payload[0];
-    /* Also place magic number at tail of every block */
+    /* Also place magic number at tail of every block not in guard mode */
 } block_element_t;
 
-static block_element_t *allocated = NULL;
-static size_t allocated_count = 0;
+/* Allocated blocks are kept in a hash set, so cautious mode can tell whether
+ * a block is allocated in constant time. The set is split into shards picked
+ * by block address, each with a lock of its own, so threads allocating at the
+ * same time seldom wait for each other. Each shard is an open-addressing table
+ * with linear probing, kept at most half full, where removal shifts the
+ * following entries back instead of leaving tombstones.
+ */
+#define ALLOCATED_SHARD_BITS 4
+#define ALLOCATED_SHARDS (1 << ALLOCATED_SHARD_BITS)
+#define ALLOCATED_MIN_SLOTS 64
+
+typedef struct {
+    pthread_mutex_t lock;
+    block_element_t **slots;
+    size_t mask;  /* Number of slots minus one */
+    size_t count; /* Number of blocks in the shard */
+} allocated_shard_t;
+
+static allocated_shard_t allocated[ALLOCATED_SHARDS] = {
+    [0 ... ALLOCATED_SHARDS - 1] = {.lock = PTHREAD_MUTEX_INITIALIZER},
+};
+static atomic_size_t allocated_count = 0;
 
 /* Percent probability of malloc failure */
 int fail_probability = 0;
 
+/* In arena mode, blocks of up to ARENA_MAX_BLOCK bytes, counting header and
+ * footer, are carved out of slabs, each serving a single size class, rather
+ * than allocated by malloc. Freed blocks are stacked per size class and reused
+ * by the next allocation of their class, so allocation-heavy code spends its
+ * time in the code under test rather than in the C library. Slabs are kept
+ * until the program exits. Blocks remember where they came from, so the mode
+ * can be switched while blocks are allocated.
+ */
+int arena_mode = 0;
+
+#define ARENA_SLAB_SIZE (64 * 1024)
+#define ARENA_MAX_BLOCK 8192
+
+/* Size classes go 32, 48, 64, 96, 128 and so on up to ARENA_MAX_BLOCK bytes,
+ * two per power of two, all multiples of 16 to keep payloads aligned
+ */
+#define ARENA_CLASSES 17
+
+static inline size_t arena_class_size(uint32_t c)
+{
+    return (size_t) (c & 1 ? 48 : 32) << (c / 2);
+}
+
+/* Slabs are chained from their first bytes, so they stay reachable */
+typedef union __arena_slab {
+    union __arena_slab *next;
+    max_align_t align;
+} arena_slab_t;
+
+static struct {
+    pthread_mutex_t lock;
+    arena_slab_t *slabs;       /* slabs of the class, newest first */
+    block_element_t *free;     /* freed blocks, linked through their payload */
+    unsigned char *bump, *end; /* unused part of the newest slab */
+} arena[ARENA_CLASSES] = {
+    [0 ... ARENA_CLASSES - 1] = {.lock = PTHREAD_MUTEX_INITIALIZER},
+};
+
+/* In guard mode, every block is given pages of its own, followed by a page
+ * which may not be accessed at all. The payload ends right at that page and
+ * has no footer, so writing even one byte past it faults at the very
+ * instruction. The payload is thus only aligned as far as its size is, like
+ * in Electric Fence: enough for an object or an array of objects of that
+ * size, though not for strings of odd length. Freed blocks are made
+ * inaccessible and quarantined until GUARD_QUARANTINE more blocks have been
+ * freed, so accessing them faults as well. Each block costs two pages and two
+ * mappings at least, so the mode is meant for debugging rather than for big
+ * traces.
+ */
+int guard_mode = 0;
+
+#define GUARD_QUARANTINE 1024
+
+/* size_class of blocks which have pages of their own */
+#define GUARD_CLASS UINT32_MAX
+
+static struct {
+    pthread_mutex_t lock;
+    struct {
+        void *base;
+        size_t len;
+    } blocks[GUARD_QUARANTINE]; /* mappings of freed blocks, oldest at next */
+    size_t next;
+} quarantine = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
 static bool cautious_mode = true;
 static bool noallocate_mode = false;
-static bool error_occurred = false;
+static atomic_bool error_occurred = false;
 static char *error_message = "";
 
-static int time_limit = 1;
+int time_limit = 1;
 
 /* Data for managing exceptions */
 static jmp_buf env;
@@ -67,17 +158,222 @@ typedef enum {
 
 /* Internal functions */
 
-/* Should this allocation fail? */
+/* Should this allocation fail?
+ * Each thread draws from a xorshift generator of its own, seeded by random()
+ * on its first draw.
+ */
 static bool fail_allocation()
 {
-    double weight = (double) random() / RAND_MAX;
+    static _Thread_local uint64_t state = 0;
+    if (!fail_probability)
+        return false;
+
+    if (!state)
+        state = ((uint64_t) random() << 32 | random()) | 1;
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    double weight = ((state * 0x2545f4914f6cdd1dULL) >> 11) * 0x1.0p-53;
     return (weight < 0.01 * fail_probability);
 }
 
-/* Find header of block, given its payload.
+static inline uint64_t block_hash(const block_element_t *b)
+{
+    return (uint64_t) (uintptr_t) b * 0x9e3779b97f4a7c15ULL;
+}
+
+/* Shard of the hash set a block belongs to, picked by the top hash bits */
+static inline allocated_shard_t *shard_of(const block_element_t *b)
+{
+    return &allocated[block_hash(b) >> (64 - ALLOCATED_SHARD_BITS)];
+}
+
+/* Home slot of a block in its shard */
+static inline size_t shard_home(const allocated_shard_t *s,
+                                const block_element_t *b)
+{
+    uint64_t h = block_hash(b);
+    return (size_t) (h ^ (h >> 32)) & s->mask;
+}
+
+/* Find the slot holding block, or the empty slot ending its probe sequence */
+static size_t shard_slot(const allocated_shard_t *s, const block_element_t *b)
+{
+    size_t i = shard_home(s, b);
+    while (s->slots[i] && s->slots[i] != b)
+        i = (i + 1) & s->mask;
+    return i;
+}
+
+/* Add block to the hash set, doubling its shard when it gets half full.
+ * Return false if the shard could not grow.
+ */
+static bool allocated_add(block_element_t *b)
+{
+    allocated_shard_t *s = shard_of(b);
+    pthread_mutex_lock(&s->lock);
+    if (2 * (s->count + 1) > s->mask + 1) {
+        size_t old_slots = s->slots ? s->mask + 1 : 0;
+        size_t slots = old_slots ? 2 * old_slots : ALLOCATED_MIN_SLOTS;
+        block_element_t **old = s->slots;
+        s->slots = calloc(slots, sizeof(*s->slots));
+        if (!s->slots) {
+            s->slots = old;
+            pthread_mutex_unlock(&s->lock);
+            return false;
+        }
+
+        s->mask = slots - 1;
+        for (size_t i = 0; i < old_slots; i++) {
+            if (old[i])
+                s->slots[shard_slot(s, old[i])] = old[i];
+        }
+        free(old);
+    }
+
+    s->slots[shard_slot(s, b)] = b;
+    s->count++;
+    pthread_mutex_unlock(&s->lock);
+    atomic_fetch_add_explicit(&allocated_count, 1, memory_order_relaxed);
+    return true;
+}
+
+/* Remove block from the hash set. Return false if it is not there */
+static bool allocated_remove(const block_element_t *b)
+{
+    allocated_shard_t *s = shard_of(b);
+    pthread_mutex_lock(&s->lock);
+    size_t i = s->slots ? shard_slot(s, b) : 0;
+    if (!s->slots || !s->slots[i]) {
+        pthread_mutex_unlock(&s->lock);
+        return false;
+    }
+
+    /* Shift back every following entry whose home slot is not between the
+     * hole and the entry itself, so no probe sequence gets broken
+     */
+    for (size_t j = (i + 1) & s->mask; s->slots[j]; j = (j + 1) & s->mask) {
+        size_t home = shard_home(s, s->slots[j]);
+        if (((j - home) & s->mask) >= ((j - i) & s->mask)) {
+            s->slots[i] = s->slots[j];
+            i = j;
+        }
+    }
+    s->slots[i] = NULL;
+    s->count--;
+    pthread_mutex_unlock(&s->lock);
+    atomic_fetch_sub_explicit(&allocated_count, 1, memory_order_relaxed);
+    return true;
+}
+
+/* Carve a block of at least @bytes bytes out of the slabs of its size class */
+static block_element_t *arena_alloc(size_t bytes)
+{
+    uint32_t c = 0;
+    while (arena_class_size(c) < bytes)
+        c++;
+
+    pthread_mutex_lock(&arena[c].lock);
+    block_element_t *b = arena[c].free;
+    if (b) {
+        arena[c].free = *(block_element_t **) b->payload;
+    } else {
+        if (arena[c].end - arena[c].bump < (ptrdiff_t) arena_class_size(c)) {
+            arena_slab_t *slab = malloc(ARENA_SLAB_SIZE);
+            if (!slab) {
+                pthread_mutex_unlock(&arena[c].lock);
+                return NULL;
+            }
+            slab->next = arena[c].slabs;
+            arena[c].slabs = slab;
+            arena[c].bump = (unsigned char *) (slab + 1);
+            arena[c].end = (unsigned char *) slab + ARENA_SLAB_SIZE;
+        }
+        b = (block_element_t *) arena[c].bump;
+        arena[c].bump += arena_class_size(c);
+    }
+    pthread_mutex_unlock(&arena[c].lock);
+
+    b->size_class = c + 1;
+    return b;
+}
+
+/* Bytes mapped ahead of the guard page of a block of @bytes bytes */
+static size_t guard_span(size_t bytes)
+{
+    size_t page = sysconf(_SC_PAGESIZE);
+    return (bytes + page - 1) & ~(page - 1);
+}
+
+/* Map a block of @bytes bytes ending right at an inaccessible page */
+static block_element_t *guard_alloc(size_t bytes)
+{
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t span = guard_span(bytes);
+    unsigned char *base = mmap(NULL, span + page, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+        return NULL;
+    if (mprotect(base + span, page, PROT_NONE)) {
+        munmap(base, span + page);
+        return NULL;
+    }
+
+    block_element_t *b = (block_element_t *) (base + span - bytes);
+    b->size_class = GUARD_CLASS;
+    return b;
+}
+
+/* Make a block inaccessible and quarantine it, unmapping the oldest
+ * quarantined block
+ */
+static void guard_release(block_element_t *b)
+{
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t bytes = b->payload_size + sizeof(block_element_t);
+    size_t span = guard_span(bytes);
+    unsigned char *base = b->payload + b->payload_size - span;
+    mprotect(base, span, PROT_NONE);
+
+    pthread_mutex_lock(&quarantine.lock);
+    void *old = quarantine.blocks[quarantine.next].base;
+    size_t old_len = quarantine.blocks[quarantine.next].len;
+    quarantine.blocks[quarantine.next].base = base;
+    quarantine.blocks[quarantine.next].len = span + page;
+    quarantine.next = (quarantine.next + 1) % GUARD_QUARANTINE;
+    pthread_mutex_unlock(&quarantine.lock);
+
+    if (old)
+        munmap(old, old_len);
+}
+
+/* Give a block back to the slabs, to malloc or to the kernel, wherever it
+ * came from
+ */
+static void release_block(block_element_t *b)
+{
+    if (!b->size_class) {
+        free(b);
+        return;
+    }
+
+    if (b->size_class == GUARD_CLASS) {
+        guard_release(b);
+        return;
+    }
+
+    uint32_t c = b->size_class - 1;
+    pthread_mutex_lock(&arena[c].lock);
+    *(block_element_t **) b->payload = arena[c].free;
+    arena[c].free = b;
+    pthread_mutex_unlock(&arena[c].lock);
+}
+
+/* Find header of block, given its payload, and take the block out of the
+ * hash set. Set found to whether it was there.
  * Signal error if doesn't seem like legitimate block
  */
-static block_element_t *find_header(void *p)
+static block_element_t *find_header(void *p, bool *found)
 {
     if (!p) {
         report_event(MSG_ERROR, "Attempting to free null block");
@@ -86,15 +382,10 @@ static block_element_t *find_header(void *p)
 
     block_element_t *b =
         (block_element_t *) ((size_t) p - sizeof(block_element_t));
+    *found = allocated_remove(b);
     if (cautious_mode) {
         /* Make sure this is really an allocated block */
-        block_element_t *ab = allocated;
-        bool found = false;
-        while (ab && !found) {
-            found = ab == b;
-            ab = ab->next;
-        }
-        if (!found) {
+        if (!*found) {
             report_event(MSG_ERROR,
                          "Attempted to free unallocated block.  Address = %p",
                          p);
@@ -142,8 +433,17 @@ static void *alloc(alloc_t alloc_type, size_t size)
         return NULL;
     }
 
-    block_element_t *new_block =
-        malloc(size + sizeof(block_element_t) + sizeof(size_t));
+    size_t bytes = size + sizeof(block_element_t) + sizeof(size_t);
+    block_element_t *new_block;
+    if (guard_mode) {
+        new_block = guard_alloc(bytes - sizeof(size_t));
+    } else if (arena_mode && bytes <= ARENA_MAX_BLOCK) {
+        new_block = arena_alloc(bytes);
+    } else {
+        new_block = malloc(bytes);
+        if (new_block)
+            new_block->size_class = 0;
+    }
     if (!new_block) {
         report_event(MSG_FATAL, "Couldn't allocate any more memory");
         error_occurred = true;
@@ -153,18 +453,15 @@ static void *alloc(alloc_t alloc_type, size_t size)
     new_block->magic_header = MAGICHEADER;
     // cppcheck-suppress nullPointerRedundantCheck
     new_block->payload_size = size;
-    *find_footer(new_block) = MAGICFOOTER;
+    if (new_block->size_class != GUARD_CLASS)
+        *find_footer(new_block) = MAGICFOOTER;
     void *p = (void *) &new_block->payload;
     memset(p, !alloc_type * FILLCHAR, size);
-    // cppcheck-suppress nullPointerRedundantCheck
-    new_block->next = allocated;
-    // cppcheck-suppress nullPointerRedundantCheck
-    new_block->prev = NULL;
-
-    if (allocated)
-        allocated->prev = new_block;
-    allocated = new_block;
-    allocated_count++;
+    if (!allocated_add(new_block)) {
+        release_block(new_block);
+        report_event(MSG_FATAL, "Couldn't allocate any more memory");
+        return NULL;
+    }
 
     return p;
 }
@@ -197,9 +494,11 @@ void test_free(void *p)
     if (!p)
         return;
 
-    block_element_t *b = find_header(p);
-    size_t footer = *find_footer(b);
-    if (footer != MAGICFOOTER) {
+    bool found;
+    block_element_t *b = find_header(p, &found);
+    /* Blocks in guard mode have no footer, but a guard page instead */
+    bool footed = b->size_class != GUARD_CLASS;
+    if (footed && *find_footer(b) != MAGICFOOTER) {
         report_event(MSG_ERROR,
                      "Corruption detected in block with address %p when "
                      "attempting to free it",
@@ -207,21 +506,13 @@ void test_free(void *p)
         error_occurred = true;
     }
     b->magic_header = MAGICFREE;
-    *find_footer(b) = MAGICFREE;
+    if (footed)
+        *find_footer(b) = MAGICFREE;
     memset(p, FILLCHAR, b->payload_size);
 
-    /* Unlink from list */
-    block_element_t *bn = b->next;
-    block_element_t *bp = b->prev;
-    if (bp)
-        bp->next = bn;
-    else
-        allocated = bn;
-    if (bn)
-        bn->prev = bp;
-
-    free(b);
-    allocated_count--;
+    /* Leave alone memory which is not an allocated block */
+    if (found)
+        release_block(b);
 }
 
 // cppcheck-suppress unusedFunction
@@ -237,7 +528,7 @@ char *test_strdup(const char *s)
 
 size_t allocation_check()
 {
-    return allocated_count;
+    return atomic_load(&allocated_count);
 }
 
 /* Implementation of functions for testing */
@@ -261,9 +552,7 @@ void set_noallocate_mode(bool noallocate)
 /* Return whether any errors have occurred since last time set error limit */
 bool error_check()
 {
-    bool e = error_occurred;
-    error_occurred = false;
-    return e;
+    return atomic_exchange(&error_occurred, false);
 }
 
 /* Prepare for a risky operation using setjmp.
@@ -8,6 +8,10 @@
 /* This test harness enables us to do stringent testing of code.
  * It overloads the library versions of malloc and free with ones that
  * allow checking for common allocation errors.
+ *
+ * Blocks may be allocated and freed by several threads at once. The modes,
+ * the parameters and the exception handling below are meant to be driven by
+ * the main thread only.
  */
 
 void *test_malloc(size_t size);
@@ -24,6 +28,15 @@ size_t allocation_check();
 /* Probability of malloc failing, expressed as percent */
 extern int fail_probability;
 
+/* Whether small blocks are carved out of per-size-class slabs */
+extern int arena_mode;
+
+/* Whether blocks are placed right in front of inaccessible pages */
+extern int guard_mode;
+
+/* Time limit of an operation run under exception_setup(), in seconds */
+extern int time_limit;
+
 /*
  * Set/unset cautious mode.
  * In this mode, makes extra sure any block to be freed is currently allocated.
@@ -0,0 +1,137 @@
+#include "mpmc.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "harness.h"
+
+/* Create an empty queue */
+mpmc_t *mpmc_new(size_t capacity)
+{
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    mpmc_t *q = malloc(sizeof(mpmc_t));
+    if (q == NULL) {
+        return NULL;
+    }
+
+    q->cells = malloc(sizeof(mpmc_cell_t) * size);
+    if (q->cells == NULL) {
+        free(q);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        atomic_init(&q->cells[i].seq, i);
+    }
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->head, 0);
+    q->mask = size - 1;
+    return q;
+}
+
+/* Free all storage used by queue */
+void mpmc_free(mpmc_t *q)
+{
+    if (q == NULL) {
+        return;
+    }
+
+    free(q->cells);
+    free(q);
+}
+
+/* Insert an item at the tail */
+bool mpmc_insert(mpmc_t *q, void *item)
+{
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    mpmc_cell_t *cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+        if (diff == 0) {
+            /* The cell is free in this lap, claim it */
+            if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* The cell still holds the item of the previous lap */
+            return false;
+        } else {
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+        }
+    }
+
+    cell->item = item;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+/* Remove the item at the head */
+void *mpmc_remove(mpmc_t *q)
+{
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+    mpmc_cell_t *cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+        if (diff == 0) {
+            /* The cell is filled in this lap, claim it */
+            if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* The cell has not been filled in this lap yet */
+            return NULL;
+        } else {
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+        }
+    }
+
+    void *item = cell->item;
+    /* Make the cell free for the next lap */
+    atomic_store_explicit(&cell->seq, pos + q->mask + 1, memory_order_release);
+    return item;
+}
+
+/* Insert a copy of a string at the tail */
+bool mpmc_insert_str(mpmc_t *q, const char *s)
+{
+    char *copy = strdup(s);
+    if (copy == NULL) {
+        return false;
+    }
+
+    if (!mpmc_insert(q, copy)) {
+        free(copy);
+        return false;
+    }
+
+    return true;
+}
+
+/* Remove the string at the head */
+bool mpmc_remove_str(mpmc_t *q, char *sp, size_t bufsize)
+{
+    char *s = mpmc_remove(q);
+    if (s == NULL) {
+        return false;
+    }
+
+    if (sp != NULL) {
+        strncpy(sp, s, bufsize - 1);
+        sp[bufsize - 1] = '\0';
+    }
+
+    free(s);
+    return true;
+}
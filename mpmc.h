@@ -0,0 +1,113 @@
+#ifndef LAB0_MPMC_H
+#define LAB0_MPMC_H
+
+/* This program implements a lock-free bounded queue which any number of
+ * threads may insert into and remove from concurrently.
+ *
+ * Items are pointers stored in a ring of cells, after Dmitry Vyukov's bounded
+ * MPMC queue. Each cell carries a sequence number telling whether it is ready
+ * to be filled or emptied in the current lap around the ring, so a thread
+ * claims a cell with a single compare-and-swap on the tail (head) index and
+ * then publishes it by a release store of its sequence number. Cells are never
+ * freed while the queue is in use, so no memory reclamation scheme is needed.
+ *
+ * Reference:
+ * https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cacheline.h"
+
+/**
+ * mpmc_cell_t - A cell of the ring
+ * @seq: the index the cell is ready to be filled for, plus one once filled
+ * @item: the item stored in the cell
+ */
+typedef struct {
+    atomic_size_t seq;
+    void *item;
+} mpmc_cell_t;
+
+/**
+ * mpmc_t - Multi-producer/multi-consumer bounded queue
+ * @tail: index of the next cell to fill
+ * @head: index of the next cell to empty
+ * @mask: the number of cells minus one
+ * @cells: the ring of cells
+ *
+ * The padding keeps both indices on cache lines of their own.
+ */
+typedef struct {
+    atomic_size_t tail;
+    char pad_tail[CACHE_LINE_SIZE];
+    atomic_size_t head;
+    char pad_head[CACHE_LINE_SIZE];
+    size_t mask;
+    mpmc_cell_t *cells;
+} mpmc_t;
+
+/**
+ * mpmc_new() - Create an empty queue
+ * @capacity: the least number of items the queue must hold, rounded up to a
+ * power of two of at least 2
+ *
+ * Return: NULL for allocation failed
+ */
+mpmc_t *mpmc_new(size_t capacity);
+
+/**
+ * mpmc_free() - Free all storage used by queue, no effect if @q is NULL
+ * @q: the queue, which no thread may be using any more
+ *
+ * The items left in the queue are not freed.
+ */
+void mpmc_free(mpmc_t *q);
+
+/**
+ * mpmc_insert() - Insert an item at the tail
+ * @q: the queue
+ * @item: the item, which must not be NULL
+ *
+ * Return: true for success, false if the queue is full
+ */
+bool mpmc_insert(mpmc_t *q, void *item);
+
+/**
+ * mpmc_remove() - Remove the item at the head
+ * @q: the queue
+ *
+ * Return: the item, NULL if the queue is empty
+ */
+void *mpmc_remove(mpmc_t *q);
+
+/**
+ * mpmc_insert_str() - Insert a copy of a string at the tail
+ * @q: the queue
+ * @s: the string
+ *
+ * The copy is allocated through the harness, and is freed by the thread which
+ * removes it with mpmc_remove_str().
+ *
+ * Return: true for success, false if the copy could not be allocated or the
+ * queue is full
+ */
+bool mpmc_insert_str(mpmc_t *q, const char *s);
+
+/**
+ * mpmc_remove_str() - Remove the string at the head
+ * @q: the queue
+ * @sp: buffer the string is copied to, which is always null-terminated,
+ * nothing is copied if @sp is NULL
+ * @bufsize: size of @sp
+ *
+ * Only strings inserted by mpmc_insert_str() may be removed this way. At most
+ * @bufsize - 1 characters are copied, and the storage of the string is freed.
+ *
+ * Return: true for success, false if the queue is empty
+ */
+bool mpmc_remove_str(mpmc_t *q, char *sp, size_t bufsize);
+
+#endif /* LAB0_MPMC_H */
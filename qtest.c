@@ -3,8 +3,12 @@
 #include <assert.h>
 #include <errno.h>
 #include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <setjmp.h>
 #include <signal.h>
 #include <spawn.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -45,7 +49,11 @@ extern int show_entropy;
 #include "queue.h"
 
 #include "console.h"
+#include "deque.h"
+#include "mpmc.h"
 #include "report.h"
+#include "spsc.h"
+#include "wsdeque.h"
 
 /* Settable parameters */
 
@@ -53,7 +61,6 @@ extern int show_entropy;
 
 /* How large is a queue before it's considered big.
  * This affects how it gets printed
- * and whether cautious mode is used when freeing the queue
  */
 #define BIG_LIST_SIZE 30
 
@@ -101,9 +108,6 @@ static bool do_free(int argc, char *argv[])
     }
     error_check();
 
-    if (current && current->size > BIG_LIST_SIZE)
-        set_cautious_mode(false);
-
     struct list_head *qnext = NULL;
     if (chain.size > 1) {
         qnext = (current->chain.next == &chain.head) ? chain.head.next
@@ -116,7 +120,6 @@ static bool do_free(int argc, char *argv[])
         if (exception_setup(true))
             q_free(current->q);
         exception_cancel();
-        set_cautious_mode(true);
     }
 
     if (current) {
@@ -180,6 +183,83 @@ static void fill_rand_string(char *buf, size_t buf_size)
     buf[len] = '\0';
 }
 
+/* Insert @reps strings with a single call, @inserts each time unless
+ * @need_rand */
+static bool queue_insert_bulk(position_t pos,
+                              char *inserts,
+                              bool need_rand,
+                              int reps)
+{
+    char **strs = malloc(sizeof(char *) * reps);
+    char(*bufs)[MAX_RANDSTR_LEN] =
+        need_rand ? malloc(sizeof(*bufs) * reps) : NULL;
+    if (!strs || (need_rand && !bufs)) {
+        free(strs);
+        free(bufs);
+        report(1, "INTERNAL ERROR.  Could not allocate space for %d strings",
+               reps);
+        return false;
+    }
+
+    for (int r = 0; r < reps; r++) {
+        strs[r] = inserts;
+        if (need_rand) {
+            fill_rand_string(bufs[r], sizeof(bufs[r]));
+            strs[r] = bufs[r];
+        }
+    }
+
+    bool ok = true, rval = false;
+    if (exception_setup(true))
+        rval = pos == POS_TAIL ? q_insert_tail_bulk(current->q, strs, reps)
+                               : q_insert_head_bulk(current->q, strs, reps);
+    exception_cancel();
+
+    if (rval) {
+        current->size += reps;
+        /* The last string inserted is at the end, the first one reps - 1
+         * nodes away from it */
+        struct list_head *cur = pos == POS_TAIL ? current->q->prev
+                                                : current->q->next;
+        char *lasts = NULL;
+        for (int r = reps - 1; ok && r >= 0; r--) {
+            char *cur_inserts = list_entry(cur, element_t, list)->value;
+            if (!cur_inserts) {
+                report(1, "ERROR: Failed to save copy of string in queue");
+                ok = false;
+            } else if (cur_inserts == strs[r]) {
+                report(1,
+                       "ERROR: Need to allocate and copy string for new "
+                       "queue element");
+                ok = false;
+            } else if (cur_inserts == lasts) {
+                report(1,
+                       "ERROR: Need to allocate separate string for each "
+                       "queue element");
+                ok = false;
+            }
+            lasts = cur_inserts;
+            cur = pos == POS_TAIL ? cur->prev : cur->next;
+        }
+    } else {
+        fail_count++;
+        if (fail_count < fail_limit)
+            report(2, "Insertion of %d strings failed", reps);
+        else {
+            report(1,
+                   "ERROR: Insertion of %d strings failed (%d failures total)",
+                   reps, fail_count);
+            ok = false;
+        }
+    }
+    ok = ok && !error_check();
+
+    free(strs);
+    free(bufs);
+    q_show(3);
+    return ok;
+}
+
 /* insertion */
 static bool queue_insert(position_t pos, int argc, char *argv[])
 {
@@ -226,6 +306,11 @@ static bool queue_insert(position_t pos, int argc, char *argv[])
                pos == POS_TAIL ? "tail" : "head");
     error_check();
 
+    /* Repeated insertions are done in bulk, unless allocations are made to
+     * fail: one by one, failures still hit insertions partway through */
+    if (current && current->q && reps > 1 && !fail_probability)
+        return queue_insert_bulk(pos, inserts, need_rand, reps);
+
     if (current && exception_setup(true)) {
         for (int r = 0; ok && r < reps; r++) {
             if (need_rand)
@@ -417,6 +502,60 @@ static inline bool do_rt(int argc, char *argv[])
     return queue_remove(POS_TAIL, argc, argv);
 }
 
+/* A string of the queue and its position, sorted to find duplicates. Equal
+ * strings have equal prefixes, which are compared first as integers. */
+typedef struct {
+    uint64_t prefix;
+    char *value;
+    size_t pos;
+} dup_entry_t;
+
+static int cmp_dup_entry(const void *a, const void *b)
+{
+    const dup_entry_t *x = a, *y = b;
+    if (x->prefix != y->prefix)
+        return x->prefix < y->prefix ? -1 : 1;
+    return strcmp(x->value, y->value);
+}
+
+/* Find the elements of @l whose string occurs more than once anywhere in it.
+ * Return an array of flags indexed by position, NULL for allocation failed */
+static bool *find_duplicates(struct list_head *l)
+{
+    size_t n = 0;
+    element_t *item;
+    list_for_each_entry (item, l, list)
+        n++;
+
+    bool *dup = calloc(n + 1, sizeof(bool));
+    dup_entry_t *sorted = malloc(sizeof(dup_entry_t) * (n + 1));
+    if (!dup || !sorted) {
+        free(dup);
+        free(sorted);
+        return NULL;
+    }
+
+    n = 0;
+    list_for_each_entry (item, l, list) {
+        char buf[sizeof(uint64_t)] = {0};
+        size_t len = strnlen(item->value, sizeof(buf) - 1);
+        memcpy(buf, item->value, len);
+        buf[len] = '\0';
+        memcpy(&sorted[n].prefix, buf, sizeof(buf));
+        sorted[n].value = item->value;
+        sorted[n].pos = n;
+        n++;
+    }
+    qsort(sorted, n, sizeof(dup_entry_t), cmp_dup_entry);
+    for (size_t i = 1; i < n; i++) {
+        if (!cmp_dup_entry(&sorted[i - 1], &sorted[i]))
+            dup[sorted[i - 1].pos] = dup[sorted[i].pos] = true;
+    }
+
+    free(sorted);
+    return dup;
+}
+
 static bool do_dedup(int argc, char *argv[])
 {
     if (argc != 1) {
@@ -462,30 +601,55 @@ static bool do_dedup(int argc, char *argv[])
         }
     }
 
-    bool ok = true;
+    /* Duplicates may be anywhere in the queue in DEDUP_HASH mode */
+    bool *dup = NULL;
+    if (dedup_mode == DEDUP_HASH) {
+        dup = find_duplicates(&l_copy);
+        if (!dup) {
+            list_for_each_entry_safe (item, tmp, &l_copy, list) {
+                free(item->value);
+                free(item);
+            }
+            report(1,
+                   "INTERNAL ERROR.  Could not allocate space for "
+                   "duplicate checking");
+            return false;
+        }
+    }
+
+    bool deleted = true;
     if (exception_setup(true))
-        ok = q_delete_dup(current->q);
+        deleted = q_delete_dup(current->q);
     exception_cancel();
 
-    if (!ok) {
-        list_for_each_entry_safe (item, tmp, &l_copy, list) {
-            free(item->value);
-            free(item);
+    /* The queue is not NULL, so q_delete_dup() may only fail to allocate, in
+     * which case the queue must be left as it was */
+    bool ok = true;
+    if (!deleted) {
+        fail_count++;
+        if (fail_count < fail_limit)
+            report(2, "Deletion of duplicates failed");
+        else {
+            report(1,
+                   "ERROR: Deletion of duplicates failed (%d failures total)",
+                   fail_count);
+            ok = false;
         }
-        report(1, "ERROR: Calling delete duplicate on null queue");
-        return false;
     }
 
     struct list_head *l_tmp = current->q->next;
     bool is_this_dup = false;
+    size_t pos = 0;
     // Compare between new list and old one
+    bool same = true;
     list_for_each_entry (item, &l_copy, list) {
         // Skip comparison with new list if the string is duplicate
         bool is_next_dup =
             item->list.next != &l_copy &&
             strcmp(list_entry(item->list.next, element_t, list)->value,
                    item->value) == 0;
-        if (is_this_dup || is_next_dup) {
+        bool is_dup = dup ? dup[pos++] : is_this_dup || is_next_dup;
+        if (is_dup && deleted) {
             // Update list size
             current->size--;
         } else if (l_tmp != current->q &&
@@ -493,23 +657,27 @@ static bool do_dedup(int argc, char *argv[])
                           item->value) == 0)
             l_tmp = l_tmp->next;
         else
-            ok = false;
+            same = false;
         is_this_dup = is_next_dup;
     }
     // All elements in new list should be traversed
-    ok = ok && l_tmp == current->q;
-    if (!ok)
+    same = same && l_tmp == current->q;
+    if (!same && deleted)
         report(1,
                "ERROR: Duplicate strings are in queue or distinct strings are "
                "not in queue");
+    else if (!same)
+        report(1, "ERROR: Queue changed although deletion of duplicates "
+                  "failed");
 
     list_for_each_entry_safe (item, tmp, &l_copy, list) {
         free(item->value);
         free(item);
     }
+    free(dup);
 
     q_show(3);
-    return ok && !error_check();
+    return ok && same && !error_check();
 }
 
 static bool do_reverse(int argc, char *argv[])
@@ -576,6 +744,15 @@ static bool do_size(int argc, char *argv[])
     return ok && !error_check();
 }
 
+/* Prepare for an operation running on @threads threads. The time limit only
+ * applies to an operation on a single thread, since SIGALRM would unwind this
+ * thread while the others still work on its stack and on the queues.
+ */
+static bool exception_setup_threads(int threads)
+{
+    return exception_setup(threads <= 1);
+}
+
 bool do_sort(int argc, char *argv[])
 {
     if (argc != 1) {
@@ -612,7 +789,7 @@ bool do_sort(int argc, char *argv[])
                "number of elements %d is too large, exceeds the limit %d.",
                current->size, MAX_NODES);
 
-    if (current && exception_setup(true))
+    if (current && exception_setup_threads(worker_threads))
         q_sort(current->q, descend);
     exception_cancel();
     set_noallocate_mode(false);
@@ -667,6 +844,20 @@ bool do_sort(int argc, char *argv[])
     return ok && !error_check();
 }
 
+/* Get the node at position @pos of a list of @size nodes from the nearer end */
+static struct list_head *nth_node(struct list_head *head, int size, int pos)
+{
+    struct list_head *cur = head;
+    if (pos < size / 2) {
+        for (int k = 0; k <= pos; k++)
+            cur = cur->next;
+    } else {
+        for (int k = size; k > pos; k--)
+            cur = cur->prev;
+    }
+    return cur;
+}
+
 static bool do_dm(int argc, char *argv[])
 {
     if (argc != 1) {
@@ -680,6 +871,19 @@ static bool do_dm(int argc, char *argv[])
     }
     error_check();
 
+    /* Remember the middle node and its neighbours, which should end up next
+     * to each other */
+    struct list_head *prev = NULL, *next = NULL;
+    char mid[MAXSTRING] = "";
+    if (current->size) {
+        struct list_head *node =
+            nth_node(current->q, current->size, current->size / 2);
+        prev = node->prev;
+        next = node->next;
+        strncpy(mid, list_entry(node, element_t, list)->value,
+                sizeof(mid) - 1);
+    }
+
     bool ok = true;
     if (exception_setup(true))
         ok = q_delete_mid(current->q);
@@ -687,8 +891,13 @@ static bool do_dm(int argc, char *argv[])
 
     if (!current->size)
         report(3, "Warning: Try to delete middle node to empty queue");
-    else
+    else {
         --current->size;
+        if (ok && (prev->next != next || next->prev != prev)) {
+            report(1, "ERROR: Did not delete the middle node %s", mid);
+            ok = false;
+        }
+    }
     q_show(3);
     return ok && !error_check();
 }
@@ -842,6 +1051,856 @@ static bool do_reverseK(int argc, char *argv[])
     return !error_check();
 }
 
+/* Find the first queue whose id is @id in the chain */
+static queue_contex_t *find_queue(int id)
+{
+    queue_contex_t *ctx;
+    list_for_each_entry (ctx, &chain.head, chain) {
+        if (ctx->id == id)
+            return ctx;
+    }
+    return NULL;
+}
+
+/* Ways do_move() picks the elements to move */
+enum { MOVE_HEAD, MOVE_TAIL, MOVE_RANGE };
+
+/* Move elements of the current queue to the tail of the queue given by id */
+static bool do_move(int argc, char *argv[], int how)
+{
+    int nargs = how == MOVE_RANGE ? 3 : 2;
+    if (argc != nargs + 1) {
+        report(1, "%s takes %d arguments", argv[0], nargs);
+        return false;
+    }
+
+    if (!current || !current->q) {
+        report(3, "Warning: Calling %s on null queue", argv[0]);
+        return false;
+    }
+    error_check();
+
+    int id, i, j = 0;
+    if (!get_int(argv[1], &id) || !get_int(argv[2], &i) ||
+        (how == MOVE_RANGE && !get_int(argv[3], &j))) {
+        report(1, "Invalid arguments for %s", argv[0]);
+        return false;
+    }
+
+    queue_contex_t *dst = find_queue(id);
+    if (!dst) {
+        report(1, "There is no queue with id %d", id);
+        return false;
+    }
+
+    /* Work out the positions [i, j) which should be moved */
+    int size = current->size;
+    if (how == MOVE_HEAD) {
+        j = i;
+        i = 0;
+    } else if (how == MOVE_TAIL) {
+        i = size - i;
+        j = size;
+    }
+    if (i < 0)
+        i = 0;
+    if (j > size)
+        j = size;
+    int expect = i < j ? j - i : 0;
+
+    /* Remember the ends of the range to find them at the tail afterwards */
+    struct list_head *first = NULL, *last = NULL;
+    if (expect) {
+        first = nth_node(current->q, size, i);
+        last = nth_node(current->q, size, j - 1);
+    }
+
+    int cnt = 0;
+    set_noallocate_mode(true);
+    if (exception_setup(true)) {
+        if (how == MOVE_HEAD)
+            cnt = q_move_head(current->q, dst->q, j);
+        else if (how == MOVE_TAIL)
+            cnt = q_move_tail(current->q, dst->q, size - i);
+        else
+            cnt = q_move_range(current->q, dst->q, i, j);
+    }
+    exception_cancel();
+    set_noallocate_mode(false);
+
+    bool ok = true;
+    if (cnt != expect) {
+        report(1, "ERROR: Moved %d elements, but should move %d", cnt, expect);
+        ok = false;
+    }
+
+    current->size -= expect;
+    dst->size += expect;
+    if (ok && (q_size(current->q) != current->size ||
+               q_size(dst->q) != dst->size)) {
+        report(1, "ERROR: Queue sizes are %d and %d, but should be %d and %d",
+               q_size(current->q), q_size(dst->q), current->size, dst->size);
+        ok = false;
+    }
+
+    if (ok && expect) {
+        struct list_head *cur = dst->q->prev;
+        for (int k = 1; k < expect && cur != dst->q; k++)
+            cur = cur->prev;
+        if (dst->q->prev != last || cur != first) {
+            report(1, "ERROR: Moved elements are not at the tail of queue %d",
+                   id);
+            ok = false;
+        }
+    }
+
+    q_show(3);
+    return ok && !error_check();
+}
+
+static bool do_mh(int argc, char *argv[])
+{
+    return do_move(argc, argv, MOVE_HEAD);
+}
+
+static bool do_mt(int argc, char *argv[])
+{
+    return do_move(argc, argv, MOVE_TAIL);
+}
+
+static bool do_mr(int argc, char *argv[])
+{
+    return do_move(argc, argv, MOVE_RANGE);
+}
+
+/* Where the fault caught by do_overrun() resumes */
+static sigjmp_buf overrun_env;
+
+static void overrun_handler(int sig)
+{
+    siglongjmp(overrun_env, 1);
+}
+
+/* Whether writing the byte at @c faults */
+static bool write_faults(volatile char *c)
+{
+    if (sigsetjmp(overrun_env, 1))
+        return true;
+    *c = 0;
+    return false;
+}
+
+static bool do_overrun(int argc, char *argv[])
+{
+    int n = 0;
+    if (argc != 2 || !get_int(argv[1], &n) || n < 1) {
+        report(1, "%s takes a positive number of bytes", argv[0]);
+        return false;
+    }
+
+    if (!guard_mode) {
+        report(1, "%s needs option guard 1", argv[0]);
+        return false;
+    }
+
+    struct sigaction sa = {.sa_handler = overrun_handler}, old;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGSEGV, &sa, &old);
+
+    bool ok = true;
+    for (int size = 1; ok && size <= n; size++) {
+        char *p = test_malloc(size);
+        if (!p) {
+            report(1, "ERROR: Could not allocate a block of %d bytes", size);
+            ok = false;
+            break;
+        }
+
+        if (!write_faults(p + size)) {
+            report(1,
+                   "ERROR: Writing 1 byte past a block of %d bytes did not "
+                   "fault",
+                   size);
+            ok = false;
+        }
+        test_free(p);
+    }
+
+    sigaction(SIGSEGV, &old, NULL);
+    return ok && !error_check();
+}
+
+/* FNV-1a hash of the strings removed by do_ring(), in order */
+static uint64_t ring_hash(uint64_t h, const char *s)
+{
+    for (; *s; s++)
+        h = (h ^ (unsigned char) *s) * 0x100000001b3ULL;
+    return (h ^ 0xff) * 0x100000001b3ULL;
+}
+
+/* Insert @n strings alternately at the head and the tail of a queue, then
+ * remove them alternately from the head and the tail. Return the hash of the
+ * removed strings, 0 if an operation failed */
+static uint64_t ring_queue(char (*strs)[MAX_RANDSTR_LEN + 1], int n)
+{
+    char buf[MAX_RANDSTR_LEN + 1];
+    uint64_t h = 0xcbf29ce484222325ULL;
+    struct list_head *q = q_new();
+    if (!q)
+        return 0;
+
+    for (int i = 0; i < n; i++) {
+        if (!(i & 1 ? q_insert_tail(q, strs[i]) : q_insert_head(q, strs[i]))) {
+            q_free(q);
+            return 0;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        element_t *e = i & 1 ? q_remove_tail(q, buf, sizeof(buf))
+                             : q_remove_head(q, buf, sizeof(buf));
+        q_release_element(e);
+        h = ring_hash(h, buf);
+    }
+
+    q_free(q);
+    return h;
+}
+
+/* Run the workload of ring_queue() on a deque */
+static uint64_t ring_deque(char (*strs)[MAX_RANDSTR_LEN + 1], int n)
+{
+    char buf[MAX_RANDSTR_LEN + 1];
+    uint64_t h = 0xcbf29ce484222325ULL;
+    deque_t d;
+    if (!deque_init(&d))
+        return 0;
+
+    for (int i = 0; i < n; i++) {
+        if (!(i & 1 ? deque_insert_tail(&d, strs[i])
+                    : deque_insert_head(&d, strs[i]))) {
+            deque_free(&d);
+            return 0;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        if (i & 1)
+            deque_remove_tail(&d, buf, sizeof(buf));
+        else
+            deque_remove_head(&d, buf, sizeof(buf));
+        h = ring_hash(h, buf);
+    }
+
+    deque_free(&d);
+    return h;
+}
+
+/* Sort @n strings in a deque through a queue, and check the order */
+static bool ring_sort(char (*strs)[MAX_RANDSTR_LEN + 1], int n)
+{
+    char prev[MAX_RANDSTR_LEN + 1] = "", buf[MAX_RANDSTR_LEN + 1];
+    bool ok = true;
+    deque_t d;
+    if (!deque_init(&d))
+        return false;
+
+    struct list_head *q = q_new();
+    for (int i = 0; ok && i < n; i++)
+        ok = deque_insert_tail(&d, strs[i]);
+    ok = ok && q && deque_to_queue(&d, q);
+    if (ok)
+        q_sort(q, descend);
+    ok = ok && deque_from_queue(&d, q);
+
+    for (int i = 0; ok && i < n; i++) {
+        deque_remove_head(&d, buf, sizeof(buf));
+        if (i > 0 && (descend ? strcmp(prev, buf) < 0 : strcmp(prev, buf) > 0))
+            ok = false;
+        strcpy(prev, buf);
+    }
+
+    q_free(q);
+    deque_free(&d);
+    return ok;
+}
+
+static bool do_ring(int argc, char *argv[])
+{
+    if (simulation) {
+        if (argc != 1) {
+            report(1, "%s does not need arguments in simulation mode", argv[0]);
+            return false;
+        }
+        bool ok = is_deque_insert_head_const() &&
+                  is_deque_insert_tail_const() &&
+                  is_deque_remove_head_const() && is_deque_remove_tail_const();
+        if (!ok) {
+            report(1,
+                   "ERROR: Probably not constant time or wrong implementation");
+            return false;
+        }
+        report(1, "Probably constant time");
+        return ok;
+    }
+
+    int n = 0;
+    if (argc != 2 || !get_int(argv[1], &n) || n < 1) {
+        report(1, "%s takes a positive number of strings", argv[0]);
+        return false;
+    }
+
+    char(*strs)[MAX_RANDSTR_LEN + 1] = malloc(sizeof(*strs) * n);
+    if (!strs) {
+        report(1, "INTERNAL ERROR.  Could not allocate space for strings");
+        return false;
+    }
+    for (int i = 0; i < n; i++)
+        fill_rand_string(strs[i], sizeof(strs[i]));
+
+    bool ok = false;
+    double t = 0, queue_time = 0, deque_time = 0;
+    uint64_t queue_hash = 0, deque_hash = 0;
+    if (exception_setup_threads(worker_threads)) {
+        init_time(&t);
+        queue_hash = ring_queue(strs, n);
+        queue_time = delta_time(&t);
+        deque_hash = ring_deque(strs, n);
+        deque_time = delta_time(&t);
+        ok = ring_sort(strs, n);
+    }
+    exception_cancel();
+    free(strs);
+
+    if (!queue_hash || !deque_hash) {
+        report(1, "ERROR: Could not insert %d strings", n);
+        return false;
+    }
+    if (queue_hash != deque_hash) {
+        report(1, "ERROR: The deque removed other strings than the queue");
+        return false;
+    }
+    if (!ok) {
+        report(1, "ERROR: Could not sort the deque through a queue");
+        return false;
+    }
+
+    report(1, "Queue: %.3f s, deque: %.3f s", queue_time, deque_time);
+    return !error_check();
+}
+
+/* Monotonic time in nanoseconds */
+static uint64_t now_ns(void)
+{
+#if defined(__APPLE__)
+    static mach_timebase_info_data_t info;
+    if (!info.denom)
+        mach_timebase_info(&info);
+    return mach_absolute_time() * info.numer / info.denom;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+/* Start a thread blocking every signal, which leaves them to this thread */
+static bool start_thread(pthread_t *thread, void *(*fn)(void *), void *arg)
+{
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    bool ok = pthread_create(thread, NULL, fn, arg) == 0;
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    return ok;
+}
+
+/* Shared state of the producer and consumer threads of do_spsc() */
+typedef struct {
+    spsc_t *q;
+    uint64_t *sent;    /* time each message was produced */
+    uint64_t *latency; /* time each message spent until consumed */
+    int n;
+    bool in_order;
+} spsc_bench_t;
+
+/* Push the messages 1 to n, yielding the CPU while the queue is full */
+static void *spsc_producer(void *arg)
+{
+    spsc_bench_t *b = arg;
+    for (int i = 0; i < b->n; i++) {
+        b->sent[i] = now_ns();
+        while (!spsc_push(b->q, (void *) (uintptr_t) (i + 1)))
+            sched_yield();
+    }
+    return NULL;
+}
+
+/* Pop every message, yielding the CPU while the queue is empty */
+static void *spsc_consumer(void *arg)
+{
+    spsc_bench_t *b = arg;
+    for (int i = 0; i < b->n; i++) {
+        void *item;
+        while (!(item = spsc_pop(b->q)))
+            sched_yield();
+
+        int k = (uintptr_t) item - 1;
+        b->latency[i] = now_ns() - b->sent[k];
+        if (k != i)
+            b->in_order = false;
+    }
+    return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+static bool do_spsc(int argc, char *argv[])
+{
+    int n = 0, capacity = 1024;
+    if (argc < 2 || argc > 3 || !get_int(argv[1], &n) || n < 1 ||
+        (argc == 3 && (!get_int(argv[2], &capacity) || capacity < 1))) {
+        report(1, "%s takes a positive number of messages and capacity",
+               argv[0]);
+        return false;
+    }
+
+    spsc_bench_t b = {
+        .q = spsc_new(capacity),
+        .sent = malloc(sizeof(uint64_t) * n),
+        .latency = malloc(sizeof(uint64_t) * n),
+        .n = n,
+        .in_order = true,
+    };
+    bool ok = b.q && b.sent && b.latency;
+    if (!ok)
+        report(1, "ERROR: Could not allocate the queue and %d messages", n);
+
+    double t = 0, elapsed = 0;
+    if (ok && exception_setup_threads(2)) {
+        pthread_t producer, consumer;
+        init_time(&t);
+        ok = start_thread(&consumer, spsc_consumer, &b);
+        bool spawned = ok && start_thread(&producer, spsc_producer, &b);
+
+        if (ok) {
+            if (spawned)
+                pthread_join(producer, NULL);
+            else
+                spsc_producer(&b);
+            pthread_join(consumer, NULL);
+        } else {
+            report(1, "ERROR: Could not create the consumer thread");
+        }
+        elapsed = delta_time(&t);
+    }
+    exception_cancel();
+
+    if (ok && !b.in_order) {
+        report(1, "ERROR: Messages were consumed out of order");
+        ok = false;
+    }
+    if (ok) {
+        qsort(b.latency, n, sizeof(uint64_t), cmp_u64);
+        report(1, "%d messages in %.3f s, %.0f messages/s", n, elapsed,
+               n / elapsed);
+        report(1, "Latency (ns): p50 %lu, p90 %lu, p99 %lu, p99.9 %lu, max %lu",
+               (unsigned long) b.latency[(size_t) (n - 1) * 50 / 100],
+               (unsigned long) b.latency[(size_t) (n - 1) * 90 / 100],
+               (unsigned long) b.latency[(size_t) (n - 1) * 99 / 100],
+               (unsigned long) b.latency[(size_t) (n - 1) * 999 / 1000],
+               (unsigned long) b.latency[n - 1]);
+    }
+
+    spsc_free(b.q);
+    free(b.sent);
+    free(b.latency);
+    return ok && !error_check();
+}
+
+/* Upper bound of the number of producers, and of consumers, of do_mpmc() */
+#define MPMC_MAX_THREADS 32
+
+/* Shared state of the threads of do_mpmc(), which pass the messages 0 to n-1
+ * through either the lock-free queue or a list protected by a mutex, and of
+ * do_mpstr(), which passes them as strings through the lock-free queue */
+typedef struct {
+    mpmc_t *q;                /* NULL to use the locked list */
+    bool strings;             /* pass copies of strings through q */
+    struct list_head list;    /* the locked list */
+    pthread_mutex_t lock;     /* protecting list */
+    struct list_head *nodes;  /* node of each message in the locked list */
+    int n, producers;         /* messages, and threads producing them */
+    atomic_int consumed;      /* messages consumed or dropped so far */
+    atomic_int dropped;       /* strings which could not be allocated */
+    atomic_bool *seen;        /* whether each message was consumed or dropped */
+    atomic_int extra;         /* messages consumed twice, or never produced */
+} mpmc_bench_t;
+
+typedef struct {
+    mpmc_bench_t *b;
+    int id;
+} mpmc_worker_t;
+
+/* Count message @i as consumed, or dropped */
+static void mpmc_mark(mpmc_bench_t *b, long i)
+{
+    if (i >= b->n || atomic_exchange(&b->seen[i], true))
+        atomic_fetch_add(&b->extra, 1);
+    atomic_fetch_add(&b->consumed, 1);
+}
+
+/* Produce every producers-th message, starting from the id of the worker */
+static void *mpmc_producer(void *arg)
+{
+    const mpmc_worker_t *w = arg;
+    mpmc_bench_t *b = w->b;
+    for (int i = w->id; i < b->n; i += b->producers) {
+        if (b->strings) {
+            char buf[16];
+            snprintf(buf, sizeof(buf), "%d", i);
+            /* The queue has room for every message, so only the copy can
+             * fail, when allocations are made to fail */
+            if (!mpmc_insert_str(b->q, buf)) {
+                atomic_fetch_add(&b->dropped, 1);
+                mpmc_mark(b, i);
+            }
+        } else if (b->q) {
+            while (!mpmc_insert(b->q, (void *) (uintptr_t) (i + 1)))
+                sched_yield();
+        } else {
+            pthread_mutex_lock(&b->lock);
+            list_add_tail(&b->nodes[i], &b->list);
+            pthread_mutex_unlock(&b->lock);
+        }
+    }
+    return NULL;
+}
+
+/* Consume messages until all of them are consumed */
+static void *mpmc_consumer(void *arg)
+{
+    mpmc_bench_t *b = ((const mpmc_worker_t *) arg)->b;
+    while (atomic_load(&b->consumed) < b->n) {
+        long i = -1;
+        if (b->strings) {
+            char buf[16];
+            if (mpmc_remove_str(b->q, buf, sizeof(buf)))
+                i = atol(buf);
+        } else if (b->q) {
+            void *item = mpmc_remove(b->q);
+            if (item)
+                i = (uintptr_t) item - 1;
+        } else {
+            pthread_mutex_lock(&b->lock);
+            if (!list_empty(&b->list)) {
+                i = b->list.next - b->nodes;
+                list_del(b->list.next);
+            }
+            pthread_mutex_unlock(&b->lock);
+        }
+
+        if (i < 0) {
+            sched_yield();
+            continue;
+        }
+        mpmc_mark(b, i);
+    }
+    return NULL;
+}
+
+/* Run @t producers and @t consumers over @b. Return the elapsed seconds, a
+ * negative value if the messages were not all consumed or dropped exactly
+ * once, which is reported */
+static double mpmc_run(mpmc_bench_t *b, int t)
+{
+    pthread_t threads[2 * MPMC_MAX_THREADS];
+    mpmc_worker_t workers[2 * MPMC_MAX_THREADS];
+    bool spawned[2 * MPMC_MAX_THREADS];
+    double start = 0;
+
+    b->producers = t;
+    atomic_store(&b->consumed, 0);
+    atomic_store(&b->dropped, 0);
+    atomic_store(&b->extra, 0);
+    for (int i = 0; i < b->n; i++)
+        atomic_store(&b->seen[i], false);
+    init_time(&start);
+    for (int i = 0; i < 2 * t; i++) {
+        workers[i] = (mpmc_worker_t){b, i < t ? i : i - t};
+        spawned[i] = start_thread(&threads[i],
+                                  i < t ? mpmc_producer : mpmc_consumer,
+                                  &workers[i]);
+    }
+    /* Do the work of a thread which could not be created in place, producers
+     * first so that consumers have something to consume */
+    for (int i = 0; i < 2 * t; i++) {
+        if (!spawned[i])
+            (i < t ? mpmc_producer : mpmc_consumer)(&workers[i]);
+    }
+    for (int i = 0; i < 2 * t; i++) {
+        if (spawned[i])
+            pthread_join(threads[i], NULL);
+    }
+    double elapsed = delta_time(&start);
+
+    int lost = 0;
+    for (int i = 0; i < b->n; i++)
+        lost += !atomic_load(&b->seen[i]);
+    int extra = atomic_load(&b->extra);
+    if (lost || extra) {
+        report(1,
+               "ERROR: %d messages were lost, %d consumed twice or never "
+               "produced",
+               lost, extra);
+        return -1;
+    }
+    return elapsed;
+}
+
+static bool do_mpmc(int argc, char *argv[])
+{
+    int n = 0, max_threads = 4;
+    if (argc < 2 || argc > 3 || !get_int(argv[1], &n) || n < 1 ||
+        (argc == 3 && (!get_int(argv[2], &max_threads) || max_threads < 1 ||
+                       max_threads > MPMC_MAX_THREADS))) {
+        report(1, "%s takes a positive number of messages and of threads",
+               argv[0]);
+        return false;
+    }
+
+    mpmc_bench_t b = {
+        .q = NULL,
+        .nodes = malloc(sizeof(struct list_head) * n),
+        .seen = malloc(sizeof(atomic_bool) * n),
+        .n = n,
+    };
+    mpmc_t *q = mpmc_new(1024);
+    bool ok = q && b.nodes && b.seen;
+    if (!ok)
+        report(1, "ERROR: Could not allocate the queue and %d messages", n);
+    INIT_LIST_HEAD(&b.list);
+    pthread_mutex_init(&b.lock, NULL);
+
+    if (ok && exception_setup_threads(2 * max_threads)) {
+        for (int t = 1;; t *= 2) {
+            if (t > max_threads)
+                t = max_threads;
+            b.q = q;
+            double lock_free = mpmc_run(&b, t);
+            b.q = NULL;
+            double locked = mpmc_run(&b, t);
+            if (lock_free < 0 || locked < 0) {
+                ok = false;
+                break;
+            }
+            report(1,
+                   "%d+%d threads: lock-free %.0f ops/s, locked list %.0f "
+                   "ops/s",
+                   t, t, 2 * n / lock_free, 2 * n / locked);
+            if (t == max_threads)
+                break;
+        }
+    }
+    exception_cancel();
+
+    pthread_mutex_destroy(&b.lock);
+    mpmc_free(q);
+    free(b.nodes);
+    free(b.seen);
+    return ok && !error_check();
+}
+
+static bool do_mpstr(int argc, char *argv[])
+{
+    int n = 0, t = 4;
+    if (argc < 2 || argc > 3 || !get_int(argv[1], &n) || n < 1 ||
+        (argc == 3 &&
+         (!get_int(argv[2], &t) || t < 1 || t > MPMC_MAX_THREADS))) {
+        report(1, "%s takes a positive number of strings and of threads",
+               argv[0]);
+        return false;
+    }
+
+    /* Only the allocations of the strings are made to fail */
+    int probability = fail_probability;
+    fail_probability = 0;
+    mpmc_bench_t b = {
+        .q = mpmc_new(n),
+        .strings = true,
+        .seen = malloc(sizeof(atomic_bool) * n),
+        .n = n,
+    };
+    fail_probability = probability;
+    if (!b.q || !b.seen) {
+        report(1, "ERROR: Could not allocate a queue of %d strings", n);
+        mpmc_free(b.q);
+        free(b.seen);
+        return false;
+    }
+
+    bool ok = true;
+    size_t allocated = allocation_check();
+    if (exception_setup_threads(2 * t)) {
+        double elapsed = mpmc_run(&b, t);
+        if (elapsed < 0) {
+            ok = false;
+        } else {
+            report(1, "%d+%d threads: %.0f ops/s, %d strings not allocated",
+                   t, t, 2 * n / elapsed, atomic_load(&b.dropped));
+        }
+    }
+    exception_cancel();
+
+    while (mpmc_remove_str(b.q, NULL, 0))
+        ;
+    size_t bcnt = allocation_check();
+    if (bcnt != allocated) {
+        report(1, "ERROR: %lu blocks were allocated before, %lu are now",
+               allocated, bcnt);
+        ok = false;
+    }
+
+    mpmc_free(b.q);
+    free(b.seen);
+    return ok && !error_check();
+}
+
+/* Upper bound of the number of workers of do_psort() */
+#define PSORT_MAX_WORKERS 64
+
+/* Shared state of the workers of do_psort(). The queues to sort start in the
+ * deque of worker 0, the other workers steal them. */
+typedef struct {
+    wsdeque_t *deques[PSORT_MAX_WORKERS];
+    int workers;
+    atomic_int remaining; /* queues not sorted yet */
+    atomic_int steals;    /* queues taken from the deque of another worker */
+} psort_t;
+
+typedef struct {
+    psort_t *p;
+    int id;
+    unsigned int seed;
+} psort_worker_t;
+
+/* Sort the queues of the own deque, then steal from random other workers
+ * until every queue is sorted */
+static void *psort_worker(void *arg)
+{
+    psort_worker_t *w = arg;
+    psort_t *p = w->p;
+    while (atomic_load(&p->remaining) > 0) {
+        queue_contex_t *ctx = wsdeque_pop(p->deques[w->id]);
+        if (!ctx && p->workers > 1) {
+            int victim = rand_r(&w->seed) % (p->workers - 1);
+            victim += victim >= w->id;
+            ctx = wsdeque_steal(p->deques[victim]);
+            if (ctx)
+                atomic_fetch_add(&p->steals, 1);
+        }
+
+        if (!ctx) {
+            sched_yield();
+            continue;
+        }
+        q_sort(ctx->q, descend);
+        atomic_fetch_sub(&p->remaining, 1);
+    }
+    return NULL;
+}
+
+static bool do_psort(int argc, char *argv[])
+{
+    psort_t p = {.workers = 0};
+    if (argc != 2 || !get_int(argv[1], &p.workers) || p.workers < 1 ||
+        p.workers > PSORT_MAX_WORKERS) {
+        report(1, "%s takes a number of workers from 1 to %d", argv[0],
+               PSORT_MAX_WORKERS);
+        return false;
+    }
+
+    if (!chain.size) {
+        report(3, "Warning: Calling psort without queues");
+        return true;
+    }
+    error_check();
+
+    bool ok = true;
+    for (int i = 0; i < p.workers; i++) {
+        p.deques[i] = wsdeque_new(chain.size);
+        ok = ok && p.deques[i];
+    }
+
+    int queues = 0, elements = 0;
+    queue_contex_t *ctx;
+    list_for_each_entry (ctx, &chain.head, chain) {
+        if (ok && ctx->q) {
+            ok = wsdeque_push(p.deques[0], ctx);
+            queues++;
+        }
+        elements += ctx->size;
+    }
+    atomic_init(&p.remaining, queues);
+    atomic_init(&p.steals, 0);
+    if (!ok)
+        report(1, "ERROR: Could not allocate the deques of %d workers",
+               p.workers);
+
+    double t = 0, elapsed = 0;
+    set_noallocate_mode(true);
+    if (ok && exception_setup_threads(p.workers)) {
+        pthread_t threads[PSORT_MAX_WORKERS];
+        psort_worker_t workers[PSORT_MAX_WORKERS];
+        bool spawned[PSORT_MAX_WORKERS];
+        init_time(&t);
+        for (int i = 0; i < p.workers; i++) {
+            workers[i] = (psort_worker_t){&p, i, i + 1};
+            spawned[i] =
+                i > 0 && start_thread(&threads[i], psort_worker, &workers[i]);
+        }
+        psort_worker(&workers[0]);
+        for (int i = 1; i < p.workers; i++) {
+            if (spawned[i])
+                pthread_join(threads[i], NULL);
+        }
+        elapsed = delta_time(&t);
+    }
+    exception_cancel();
+    set_noallocate_mode(false);
+
+    for (int i = 0; i < p.workers; i++)
+        wsdeque_free(p.deques[i]);
+
+    list_for_each_entry (ctx, &chain.head, chain) {
+        if (!ok || !ctx->q)
+            continue;
+        for (struct list_head *cur = ctx->q->next;
+             cur != ctx->q && cur->next != ctx->q; cur = cur->next) {
+            const char *a = list_entry(cur, element_t, list)->value;
+            const char *b = list_entry(cur->next, element_t, list)->value;
+            if (descend ? strcmp(a, b) < 0 : strcmp(a, b) > 0) {
+                report(1, "ERROR: Queue %d is not sorted", ctx->id);
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    if (ok) {
+        report(1,
+               "Sorted %d queues of %d elements in %.3f s, %.0f elements/s, "
+               "%d stolen",
+               queues, elements, elapsed, elements / elapsed,
+               atomic_load(&p.steals));
+    }
+
+    q_show(3);
+    return ok && !error_check();
+}
+
 static bool do_merge(int argc, char *argv[])
 {
     if (argc != 1) {
@@ -857,12 +1916,18 @@ static bool do_merge(int argc, char *argv[])
 
     int len = 0;
     set_noallocate_mode(true);
-    if (current && exception_setup(true))
+    int threads = merge_mode == MERGE_PAIRWISE ? worker_threads : 1;
+    if (current && exception_setup_threads(threads))
         len = q_merge(&chain.head, descend);
     exception_cancel();
     set_noallocate_mode(false);
 
-    if (q_size(&chain.head) > 1) {
+    if (chain.size > 1) {
+        if (merge_mode == MERGE_PAIRWISE) {
+            for (int i = 0; i < merge_rounds; i++)
+                report(1, "Round %d: %.3f s", i + 1, merge_round_time[i]);
+        }
+
         chain.size = 1;
         current = list_entry(chain.head.next, queue_contex_t, chain);
         current->size = len;
@@ -1056,6 +2121,39 @@ static bool do_next(int argc, char *argv[])
     return q_show(0);
 }
 
+/* Reject a number of threads below 1, keeping the previous one */
+static void set_threads(int oldval)
+{
+    if (worker_threads < 1) {
+        report(1, "ERROR: Number of threads must be at least 1");
+        worker_threads = oldval;
+    }
+}
+
+/* Reject a value of @param outside 0 to @max, keeping the previous one */
+static void check_mode(int *param, int oldval, int max, const char *name)
+{
+    if (*param < 0 || *param > max) {
+        report(1, "ERROR: %s must be between 0 and %d", name, max);
+        *param = oldval;
+    }
+}
+
+static void set_sort_mode(int oldval)
+{
+    check_mode(&sort_mode, oldval, SORT_RADIX, "Sorting algorithm");
+}
+
+static void set_merge_mode(int oldval)
+{
+    check_mode(&merge_mode, oldval, MERGE_PAIRWISE, "Merging strategy");
+}
+
+static void set_dedup_mode(int oldval)
+{
+    check_mode(&dedup_mode, oldval, DEDUP_HASH, "Duplicate removal");
+}
+
 static void console_init()
 {
     ADD_COMMAND(new, "Create new queue", "");
@@ -1096,6 +2194,40 @@ static void console_init()
                 "");
     ADD_COMMAND(reverseK, "Reverse the nodes of the queue 'K' at a time",
                 "[K]");
+    ADD_COMMAND(mh, "Move the first 'N' nodes to the tail of queue 'ID'",
+                "ID N");
+    ADD_COMMAND(mt, "Move the last 'N' nodes to the tail of queue 'ID'",
+                "ID N");
+    ADD_COMMAND(mr,
+                "Move nodes at positions 'I' to 'J'-1 to the tail of queue "
+                "'ID'",
+                "ID I J");
+    ADD_COMMAND(overrun,
+                "Write 1 byte past blocks of 1 to 'N' bytes, which must "
+                "fault in guard mode",
+                "N");
+    ADD_COMMAND(ring,
+                "Compare a queue with a ring-buffer deque on 'N' strings "
+                "inserted and removed at both ends, or test that the deque "
+                "takes constant time in simulation mode",
+                "[N]");
+    ADD_COMMAND(spsc,
+                "Pass 'N' messages through a lock-free queue of 'CAP' slots "
+                "from a producer thread to a consumer thread",
+                "[N] [CAP]");
+    ADD_COMMAND(mpmc,
+                "Pass 'N' messages through a lock-free queue and a locked "
+                "list, with 1 to 'T' producer and consumer threads",
+                "[N] [T]");
+    ADD_COMMAND(mpstr,
+                "Pass 'N' strings, allocated and freed through the harness, "
+                "through a lock-free queue with 'T' producer and consumer "
+                "threads",
+                "[N] [T]");
+    ADD_COMMAND(psort,
+                "Sort every queue on 'T' workers balanced by work-stealing "
+                "deques",
+                "[T]");
     add_param("length", &string_length, "Maximum length of displayed string",
               NULL);
     add_param("malloc", &fail_probability, "Malloc failure probability percent",
@@ -1104,6 +2236,29 @@ static void console_init()
               "Number of times allow queue operations to return false", NULL);
     add_param("descend", &descend,
               "Sort and merge queue in ascending/descending order", NULL);
+    add_param("sort", &sort_mode,
+              "Sorting algorithm (0: merge sort, 1: natural merge sort, 2: "
+              "radix sort)",
+              set_sort_mode);
+    add_param("indexed", &queue_indexed,
+              "Whether queues track their middle node for 'dm'", NULL);
+    add_param("dedup", &dedup_mode,
+              "Duplicate removal (0: adjacent strings, 1: hash table)",
+              set_dedup_mode);
+    add_param("merge", &merge_mode,
+              "Merging strategy (0: sequential, 1: min-heap, 2: pairwise)",
+              set_merge_mode);
+    add_param("threads", &worker_threads, "Number of threads to sort with",
+              set_threads);
+    add_param("arena", &arena_mode,
+              "Whether small blocks are carved out of per-size-class slabs",
+              NULL);
+    add_param("guard", &guard_mode,
+              "Whether blocks are placed right in front of inaccessible "
+              "pages, and freed blocks are kept inaccessible for a while",
+              NULL);
+    add_param("timeout", &time_limit,
+              "Time limit of each queue operation in seconds", NULL);
 }
 
 /* Signal handlers */
@@ -1136,8 +2291,6 @@ static void q_init()
 static bool q_quit(int argc, char *argv[])
 {
     report(3, "Freeing queue");
-    if (current && current->size > BIG_LIST_SIZE)
-        set_cautious_mode(false);
 
     if (exception_setup(true)) {
         struct list_head *cur = chain.head.next;
@@ -1151,7 +2304,6 @@ static bool q_quit(int argc, char *argv[])
     }
 
     exception_cancel();
-    set_cautious_mode(true);
 
     size_t bcnt = allocation_check();
     if (bcnt > 0) {
@@ -1,7 +1,10 @@
 #include "queue.h"
+#include <pthread.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "list.h"
 
 /* Notice: sometimes, Cppcheck would find the potential NULL pointer bugs,
@@ -10,17 +13,145 @@
  *   cppcheck-suppress nullPointer
  */
 
+/* Elements are carved out of chunks of POOL_CHUNK_SIZE slots, so inserting an
+ * element rarely calls into the allocator. Chunks with free slots are kept on
+ * pool_partial, most recently used first. A chunk is given back as soon as its
+ * last slot is released, hence allocation_check() stays exact once every
+ * element has been released.
+ */
+#define POOL_CHUNK_SIZE 64
+
+typedef struct __pool_chunk pool_chunk_t;
+
+typedef struct __pool_slot {
+    pool_chunk_t *chunk;
+    union {
+        struct __pool_slot *next_free;
+        element_t element;
+    };
+} pool_slot_t;
+
+struct __pool_chunk {
+    struct list_head link; /* linked in pool_partial unless full */
+    pool_slot_t *free;     /* stack of released slots */
+    int used;              /* number of slots handed out */
+    int bumped;            /* slots from this index on were never used */
+    pool_slot_t slots[POOL_CHUNK_SIZE];
+};
+
+static LIST_HEAD(pool_partial);
+
+static element_t *pool_alloc()
+{
+    if (list_empty(&pool_partial)) {
+        pool_chunk_t *chunk = malloc(sizeof(pool_chunk_t));
+        if (chunk == NULL) {
+            return NULL;
+        }
+
+        chunk->free = NULL;
+        chunk->used = 0;
+        chunk->bumped = 0;
+        list_add(&chunk->link, &pool_partial);
+    }
+
+    pool_chunk_t *chunk = list_first_entry(&pool_partial, pool_chunk_t, link);
+    pool_slot_t *slot = chunk->free;
+    if (slot != NULL) {
+        chunk->free = slot->next_free;
+    } else {
+        slot = &chunk->slots[chunk->bumped++];
+    }
+
+    slot->chunk = chunk;
+    if (++chunk->used == POOL_CHUNK_SIZE) {
+        list_del_init(&chunk->link);
+    }
+
+    return &slot->element;
+}
+
+static void pool_free(element_t *e)
+{
+    pool_slot_t *slot = container_of(e, pool_slot_t, element);
+    pool_chunk_t *chunk = slot->chunk;
+
+    if (chunk->used-- == POOL_CHUNK_SIZE) {
+        list_add(&chunk->link, &pool_partial);
+    }
+
+    if (chunk->used == 0) {
+        list_del(&chunk->link);
+        free(chunk);
+        return;
+    }
+
+    slot->next_free = chunk->free;
+    chunk->free = slot;
+}
+
+/* Release the element */
+void q_release_element(element_t *e)
+{
+    if (e->value != e->inline_value) {
+        free(e->value);
+    }
+    pool_free(e);
+}
+
+/* Get the queue head owning the list head returned by q_new() */
+static inline queue_head_t *queue_of(struct list_head *head)
+{
+    return list_entry(head, queue_head_t, head);
+}
+
+int queue_indexed = 0;
+
+/**
+ * track_mid() - Keep the middle node of a queue across a change at one end
+ * @q: the queue, whose size is not updated yet
+ * @node: the node linked at or about to be unlinked from the end
+ * @at_head: whether the end is the head rather than the tail
+ * @grow: whether @node is linked rather than unlinked
+ *
+ * The middle node is the one at index size / 2, so it moves one node toward
+ * the tail when the queue grows to an even size at its tail or shrinks to
+ * one at its head, and toward the head in the mirrored cases. It is dropped
+ * if queues are not indexed.
+ */
+static inline void track_mid(queue_head_t *q,
+                             struct list_head *node,
+                             bool at_head,
+                             bool grow)
+{
+    if (!queue_indexed || (!grow && q->size == 1)) {
+        q->mid = NULL;
+    } else if (grow && q->size == 0) {
+        q->mid = node;
+    } else if (q->mid == NULL) {
+        return;
+    } else if (q->size & 1) {
+        if (at_head != grow) {
+            q->mid = q->mid->next;
+        }
+    } else if (at_head == grow) {
+        q->mid = q->mid->prev;
+    }
+}
+
 /* Create an empty queue */
 struct list_head *q_new()
 {
-    struct list_head *q = malloc(sizeof(struct list_head));
+    queue_head_t *q = malloc(sizeof(queue_head_t));
     if (q == NULL) {
         return NULL;
     }
 
-    INIT_LIST_HEAD(q);
+    INIT_LIST_HEAD(&q->head);
+    q->mid = NULL;
+    q->size = 0;
 
-    return q;
+    return &q->head;
 }
 
 /* Free all storage used by queue */
@@ -36,23 +167,57 @@ void q_free(struct list_head *head)
         q_release_element(node);
     }
 
-    free(head);
+    free(queue_of(head));
+}
+
+/* Pack the first 8 bytes of a string into a big-endian key */
+static inline uint64_t element_key(const char *s)
+{
+    uint64_t key = 0;
+    for (int i = 0; i < 8; i++) {
+        key <<= 8;
+        if (*s) {
+            key |= (unsigned char) *s++;
+        }
+    }
+
+    return key;
+}
+
+/* Compare two elements like strcmp() does, looking at the strings only when
+ * the keys are equal and do not contain the terminator */
+static inline int element_cmp(const element_t *a, const element_t *b)
+{
+    if (a->key != b->key) {
+        return a->key < b->key ? -1 : 1;
+    }
+
+    if ((a->key & 0xff) == 0) {
+        return 0;
+    }
+
+    return strcmp(a->value + 8, b->value + 8);
 }
 
 element_t *element_new(const char *s)
 {
-    element_t *node = malloc(sizeof(element_t));
+    element_t *node = pool_alloc();
     if (node == NULL) {
         return NULL;
     }
 
-    char *value = strdup(s);
-    if (value == NULL) {
-        free(node);
-        return NULL;
+    size_t len = strlen(s) + 1;
+    char *value = node->inline_value;
+    if (len > sizeof(node->inline_value)) {
+        value = malloc(len);
+        if (value == NULL) {
+            pool_free(node);
+            return NULL;
+        }
     }
 
-    node->value = value;
+    node->value = memcpy(value, s, len);
+    node->key = element_key(s);
     INIT_LIST_HEAD(&node->list);
 
     return node;
@@ -71,6 +236,8 @@ bool q_insert_head(struct list_head *head, char *s)
     }
 
     list_add(&node->list, head);
+    track_mid(queue_of(head), &node->list, true, true);
+    queue_of(head)->size++;
 
     return true;
 }
@@ -88,10 +255,64 @@ bool q_insert_tail(struct list_head *head, char *s)
     }
 
     list_add_tail(&node->list, head);
+    track_mid(queue_of(head), &node->list, false, true);
+    queue_of(head)->size++;
 
     return true;
 }
 
+/* Build a chain of elements for @s in the order they end up in the queue, and
+ * splice it at the end given by @at_head */
+static bool insert_bulk(struct list_head *head, char **s, int n, bool at_head)
+{
+    if (head == NULL) {
+        return false;
+    }
+
+    queue_head_t *q = queue_of(head);
+    LIST_HEAD(chain);
+    for (int i = 0; i < n; i++) {
+        element_t *node = element_new(s[i]);
+        if (node == NULL) {
+            element_t *safe;
+            list_for_each_entry_safe (node, safe, &chain, list) {
+                q_release_element(node);
+            }
+            return false;
+        }
+
+        if (at_head) {
+            list_add(&node->list, &chain);
+        } else {
+            list_add_tail(&node->list, &chain);
+        }
+    }
+
+    if (n > 0) {
+        if (at_head) {
+            list_splice(&chain, head);
+        } else {
+            list_splice_tail(&chain, head);
+        }
+        q->size += n;
+        q->mid = NULL;
+    }
+
+    return true;
+}
+
+/* Insert several elements at head of queue */
+bool q_insert_head_bulk(struct list_head *head, char **s, int n)
+{
+    return insert_bulk(head, s, n, true);
+}
+
+/* Insert several elements at tail of queue */
+bool q_insert_tail_bulk(struct list_head *head, char **s, int n)
+{
+    return insert_bulk(head, s, n, false);
+}
+
 /* Remove an element from head of queue */
 element_t *q_remove_head(struct list_head *head, char *sp, size_t bufsize)
 {
@@ -100,7 +321,9 @@ element_t *q_remove_head(struct list_head *head, char *sp, size_t bufsize)
     }
 
     element_t *node = list_first_entry(head, element_t, list);
+    track_mid(queue_of(head), head->next, true, false);
     list_del_init(head->next);
+    queue_of(head)->size--;
 
     if (sp != NULL) {
         strncpy(sp, node->value, bufsize - 1);
@@ -118,7 +341,9 @@ element_t *q_remove_tail(struct list_head *head, char *sp, size_t bufsize)
     }
 
     element_t *node = list_last_entry(head, element_t, list);
+    track_mid(queue_of(head), head->prev, false, false);
     list_del_init(head->prev);
+    queue_of(head)->size--;
 
     if (sp != NULL) {
         strncpy(sp, node->value, bufsize - 1);
@@ -128,6 +353,79 @@ element_t *q_remove_tail(struct list_head *head, char *sp, size_t bufsize)
     return node;
 }
 
+/* Get the node at position @i of a queue of @size nodes, or @head itself if
+ * @i is @size, walking from the nearer end */
+static struct list_head *node_at(struct list_head *head, int size, int i)
+{
+    struct list_head *node = head;
+    if (i <= size / 2) {
+        for (node = head->next; i > 0; i--) {
+            node = node->next;
+        }
+    } else {
+        for (i = size - i; i > 0; i--) {
+            node = node->prev;
+        }
+    }
+
+    return node;
+}
+
+/* Move elements at positions [i, j) to the tail of another queue */
+int q_move_range(struct list_head *from, struct list_head *to, int i, int j)
+{
+    if (from == NULL || to == NULL) {
+        return 0;
+    }
+
+    queue_head_t *src = queue_of(from), *dst = queue_of(to);
+    if (i < 0) {
+        i = 0;
+    }
+    if (j > src->size) {
+        j = src->size;
+    }
+    if (i >= j) {
+        return 0;
+    }
+
+    struct list_head *first = node_at(from, src->size, i);
+    struct list_head *last = node_at(from, src->size, j)->prev;
+
+    /* Unlink [first, last] from its queue */
+    first->prev->next = last->next;
+    last->next->prev = first->prev;
+
+    /* Link it in at the tail of the other queue */
+    first->prev = to->prev;
+    to->prev->next = first;
+    last->next = to;
+    to->prev = last;
+
+    src->size -= j - i;
+    dst->size += j - i;
+    src->mid = dst->mid = NULL;
+
+    return j - i;
+}
+
+/* Move the first elements to the tail of another queue */
+int q_move_head(struct list_head *from, struct list_head *to, int n)
+{
+    return q_move_range(from, to, 0, n);
+}
+
+/* Move the last elements to the tail of another queue */
+int q_move_tail(struct list_head *from, struct list_head *to, int n)
+{
+    if (from == NULL || n <= 0) {
+        return 0;
+    }
+
+    int size = queue_of(from)->size;
+    return q_move_range(from, to, n < size ? size - n : 0, size);
+}
+
 /* Return number of elements in queue */
 int q_size(struct list_head *head)
 {
@@ -135,13 +433,7 @@ int q_size(struct list_head *head)
         return 0;
     }
 
-    size_t size = 0;
-    struct list_head *node;
-    list_for_each (node, head) {
-        size += 1;
-    }
-
-    return size;
+    return queue_of(head)->size;
 }
 
 /* Delete the middle node in queue */
@@ -152,19 +444,115 @@ bool q_delete_mid(struct list_head *head)
         return false;
     }
 
-    int mid = q_size(head) / 2;
-    struct list_head *cur = head->next;
-    for (int i = 0; i < mid; i++) {
-        cur = cur->next;
+    queue_head_t *q = queue_of(head);
+    struct list_head *cur = q->mid;
+    if (cur == NULL) {
+        cur = head->next;
+        for (int i = 0; i < q->size / 2; i++) {
+            cur = cur->next;
+        }
+    }
+
+    /* The next middle node is the neighbour which ends up at index
+     * (size - 1) / 2 */
+    if (queue_indexed && q->size > 1) {
+        q->mid = q->size & 1 ? cur->next : cur->prev;
+    } else {
+        q->mid = NULL;
     }
 
     element_t *node = list_entry(cur, element_t, list);
     list_del_init(&node->list);
     q_release_element(node);
+    q->size--;
 
     return true;
 }
 
+/**
+ * dup_slot_t - A slot of the table used by delete_dup_hash()
+ * @value: a string of the queue, NULL if the slot is empty
+ * @hash: the hash of @value
+ * @count: the number of elements holding @value
+ */
+typedef struct {
+    const char *value;
+    uint64_t hash;
+    size_t count;
+} dup_slot_t;
+
+/* FNV-1a hash of a string */
+static uint64_t string_hash(const char *s)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (; *s; s++) {
+        h = (h ^ (unsigned char) *s) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/* Find the slot of @value in a table of @mask + 1 slots with linear probing,
+ * which is either the slot holding it or the empty one it belongs in */
+static dup_slot_t *dup_lookup(dup_slot_t *table,
+                              size_t mask,
+                              const char *value,
+                              uint64_t hash)
+{
+    size_t i = hash & mask;
+    while (table[i].value != NULL &&
+           (table[i].hash != hash || strcmp(table[i].value, value) != 0)) {
+        i = (i + 1) & mask;
+    }
+    return &table[i];
+}
+
+/* Delete every element whose string occurs more than once anywhere in the
+ * queue, in expected linear time. The strings are counted in a first pass and
+ * the duplicates deleted in a second one, which only unlinks them: they are
+ * released at the end since the table points to their strings. */
+static bool delete_dup_hash(struct list_head *head)
+{
+    size_t size = queue_of(head)->size;
+    size_t cap = 16;
+    while (cap < 2 * size) {
+        cap <<= 1;
+    }
+
+    dup_slot_t *table = calloc(cap, sizeof(dup_slot_t));
+    if (table == NULL) {
+        return false;
+    }
+
+    element_t *e = NULL, *safe = NULL;
+    list_for_each_entry (e, head, list) {
+        uint64_t hash = string_hash(e->value);
+        dup_slot_t *slot = dup_lookup(table, cap - 1, e->value, hash);
+        if (slot->value == NULL) {
+            slot->value = e->value;
+            slot->hash = hash;
+        }
+        slot->count++;
+    }
+
+    LIST_HEAD(dups);
+    list_for_each_entry_safe (e, safe, head, list) {
+        const dup_slot_t *slot =
+            dup_lookup(table, cap - 1, e->value, string_hash(e->value));
+        if (slot->count > 1) {
+            list_move_tail(&e->list, &dups);
+            queue_of(head)->size--;
+        }
+    }
+
+    free(table);
+    list_for_each_entry_safe (e, safe, &dups, list) {
+        q_release_element(e);
+    }
+    return true;
+}
+
+int dedup_mode = DEDUP_ADJACENT;
+
 /* Delete all nodes that have duplicate string */
 bool q_delete_dup(struct list_head *head)
 {
@@ -172,6 +560,11 @@ bool q_delete_dup(struct list_head *head)
     if (head == NULL) {
         return false;
     }
+    queue_of(head)->mid = NULL;
+
+    if (dedup_mode == DEDUP_HASH) {
+        return delete_dup_hash(head);
+    }
 
     const struct list_head *end = head;
     struct list_head *cur = head;
@@ -180,15 +573,17 @@ bool q_delete_dup(struct list_head *head)
         struct list_head *check = cur->next;
         element_t *c = list_entry(check, element_t, list);
         element_t *cc = list_entry(check->next, element_t, list);
-        if (strcmp(c->value, cc->value) == 0) {
-            while (check->next != end && strcmp(c->value, cc->value) == 0) {
+        if (element_cmp(c, cc) == 0) {
+            while (check->next != end && element_cmp(c, cc) == 0) {
                 list_del_init(&cc->list);
                 q_release_element(cc);
+                queue_of(head)->size--;
 
                 cc = list_entry(c->list.next, element_t, list);
             }
             list_del_init(check);
             q_release_element(list_entry(check, element_t, list));
+            queue_of(head)->size--;
         } else {
             cur = cur->next;
         }
@@ -204,18 +599,15 @@ void q_swap(struct list_head *head)
     if (head == NULL) {
         return;
     }
+    queue_of(head)->mid = NULL;
 
+    /* Relink the nodes rather than exchanging values, since a value may be
+     * stored inline in its element */
     const struct list_head *end = head;
-    struct list_head *cur = head;
-    while (cur->next != end && cur->next->next != end) {
-        element_t *a = list_entry(cur->next, element_t, list);
-        element_t *b = list_entry(cur->next->next, element_t, list);
-
-        char *tmp = a->value;
-        a->value = b->value;
-        b->value = tmp;
-
-        cur = cur->next->next;
+    struct list_head *cur = head->next;
+    while (cur != end && cur->next != end) {
+        list_move(cur, cur->next);
+        cur = cur->next;
     }
 }
 
@@ -245,6 +637,7 @@ void q_reverse(struct list_head *head)
     if (head == NULL) {
         return;
     }
+    queue_of(head)->mid = NULL;
 
     list_reverse(head);
 }
@@ -253,135 +646,709 @@ void q_reverse(struct list_head *head)
 void q_reverseK(struct list_head *head, int k)
 {
     // https://leetcode.com/problems/reverse-nodes-in-k-group/
-    if (head == NULL) {
+    if (head == NULL || k <= 1) {
         return;
     }
+    queue_of(head)->mid = NULL;
+
+    /* Reverse the full groups in one walk: the pointers of every node of a
+     * group are swapped as it is visited, then both ends of the group are
+     * relinked to its neighbours */
+    struct list_head *before = head;
+    for (int n = queue_of(head)->size / k; n > 0; n--) {
+        struct list_head *first = before->next, *last = NULL, *cur = first;
+        for (int i = 0; i < k; i++) {
+            struct list_head *next = cur->next;
+            cur->next = cur->prev;
+            cur->prev = next;
+            last = cur;
+            cur = next;
+        }
 
-    struct list_head result;
-    INIT_LIST_HEAD(&result);
+        first->next = cur;
+        cur->prev = first;
+        last->prev = before;
+        before->next = last;
+        before = first;
+    }
+}
 
-    for (int j = q_size(head); j >= k; j -= k) {
-        const struct list_head *end = head;
-        struct list_head *cur = head->next;
+/* Compare the elements of two nodes in the requested order */
+static inline int node_cmp(const struct list_head *a,
+                           const struct list_head *b,
+                           bool descend)
+{
+    int cmp = element_cmp(list_entry(a, element_t, list),
+                          list_entry(b, element_t, list));
+    return descend ? -cmp : cmp;
+}
 
-        for (int i = 0; i < k - 1; i++) {
-            if (cur != end) {
-                cur = cur->next;
-            } else {
+/* Merge two null-terminated runs linked through their next pointers. Ties are
+ * taken from @a, so the merge is stable when @a holds the earlier nodes.
+ */
+static struct list_head *merge_runs(struct list_head *a,
+                                    struct list_head *b,
+                                    bool descend)
+{
+    struct list_head *head = NULL, **tail = &head;
+
+    for (;;) {
+        if (node_cmp(a, b, descend) <= 0) {
+            *tail = a;
+            tail = &a->next;
+            a = a->next;
+            if (a == NULL) {
+                *tail = b;
+                break;
+            }
+        } else {
+            *tail = b;
+            tail = &b->next;
+            b = b->next;
+            if (b == NULL) {
+                *tail = a;
                 break;
             }
         }
+    }
 
-        struct list_head tmp;
-        INIT_LIST_HEAD(&tmp);
-        list_cut_position(&tmp, head, cur);
+    return head;
+}
 
-        if (cur != end) {
-            list_reverse(&tmp);
+/* Merge the last two runs into @head, restoring the prev pointers */
+static void merge_final(struct list_head *head,
+                        struct list_head *a,
+                        struct list_head *b,
+                        bool descend)
+{
+    struct list_head *tail = head;
+
+    for (;;) {
+        if (node_cmp(a, b, descend) <= 0) {
+            tail->next = a;
+            a->prev = tail;
+            tail = a;
+            a = a->next;
+            if (a == NULL) {
+                break;
+            }
+        } else {
+            tail->next = b;
+            b->prev = tail;
+            tail = b;
+            b = b->next;
+            if (b == NULL) {
+                b = a;
+                break;
+            }
         }
-
-        list_splice_tail_init(&tmp, &result);
     }
 
-    list_splice_init(&result, head);
+    do {
+        tail->next = b;
+        b->prev = tail;
+        tail = b;
+        b = b->next;
+    } while (b != NULL);
+
+    tail->next = head;
+    head->prev = tail;
 }
 
 /**
- * list_merge() - Merge two sorted lists
- * @head_a: the first list
- * @head_b: the second list
+ * list_sort() - Sort a list with a bottom-up merge sort
+ * @head: the list to sort
+ * @descend: whether or not to sort in descending order
+ *
+ * Nodes are moved one by one onto a stack of pending runs, which are
+ * singly-linked through next and chained through the prev pointer of their
+ * first node. Two runs of 2^k nodes are merged as soon as a third run of that
+ * size follows, which keeps every merge at worst 2:1 balanced while the runs
+ * being merged are still in cache. The prev pointers are rebuilt once, by the
+ * final merge. The sort is stable.
  *
- * Merge two sorted lists into one sorted list. The result is stored in head_a.
+ * Adapted from lib/list_sort.c of the Linux kernel.
  */
-void list_merge(struct list_head *head_a,
-                struct list_head *head_b,
-                bool descend)
+static void list_sort(struct list_head *head, bool descend)
 {
-    struct list_head head;
-    INIT_LIST_HEAD(&head);
+    struct list_head *list = head->next, *pending = NULL;
+    size_t count = 0;
+
+    if (list == head->prev) {
+        return;
+    }
 
-    while (!list_empty(head_a) && !list_empty(head_b)) {
-        element_t *a = list_first_entry(head_a, element_t, list);
-        element_t *b = list_first_entry(head_b, element_t, list);
+    head->prev->next = NULL;
+
+    do {
+        size_t bits;
+        struct list_head **tail = &pending;
+
+        /* Find the least-significant clear bit in count */
+        for (bits = count; bits & 1; bits >>= 1) {
+            tail = &(*tail)->prev;
+        }
+
+        /* Merge the two runs below it unless count is 2^k - 1 */
+        if (bits) {
+            struct list_head *a = *tail, *b = a->prev;
+
+            a = merge_runs(b, a, descend);
+            a->prev = b->prev;
+            *tail = a;
+        }
+
+        /* Move one node from the input onto the pending stack */
+        list->prev = pending;
+        pending = list;
+        list = list->next;
+        pending->next = NULL;
+        count++;
+    } while (list != NULL);
+
+    /* Merge all the pending runs together */
+    list = pending;
+    pending = pending->prev;
+    for (;;) {
+        struct list_head *next = pending->prev;
+
+        if (next == NULL) {
+            break;
+        }
+        list = merge_runs(pending, list, descend);
+        pending = next;
+    }
+
+    merge_final(head, pending, list, descend);
+}
+
+/* Number of consecutive wins of one run before a merge starts galloping */
+#define MIN_GALLOP 7
+
+/* Enough for any list, since natural_sort() keeps the run lengths on its stack
+ * growing at least like the Fibonacci numbers */
+#define MAX_PENDING_RUNS 85
+
+/* Find the last node of the run starting at @node for which it sorts before
+ * @pivot, or not after it unless @strict is set. The condition must hold for
+ * @node itself. The run is probed at exponentially growing distances, then
+ * the last step is bisected, so finding a block of n nodes takes O(log n)
+ * comparisons.
+ */
+static struct list_head *gallop(struct list_head *node,
+                                const struct list_head *pivot,
+                                bool strict,
+                                bool descend)
+{
+    struct list_head *lo = node, *hi;
+    size_t step = 1, dist;
+
+    for (;;) {
+        hi = lo;
+        for (dist = 0; dist < step && hi->next != NULL; dist++) {
+            hi = hi->next;
+        }
 
-        if ((strcmp(a->value, b->value) < 0) == !descend) {
-            list_del_init(&a->list);
-            list_add_tail(&a->list, &head);
+        if (hi == lo) {
+            return lo;
+        }
+
+        int cmp = node_cmp(hi, pivot, descend);
+        if (strict ? cmp >= 0 : cmp > 0) {
+            break;
+        }
+
+        lo = hi;
+        step <<= 1;
+    }
+
+    /* The answer is lo or one of the dist - 1 nodes between lo and hi */
+    dist--;
+    while (dist > 0) {
+        size_t half = dist / 2;
+        struct list_head *mid = lo;
+        for (size_t i = 0; i <= half; i++) {
+            mid = mid->next;
+        }
+
+        int cmp = node_cmp(mid, pivot, descend);
+        if (strict ? cmp < 0 : cmp <= 0) {
+            lo = mid;
+            dist -= half + 1;
+        } else {
+            dist = half;
+        }
+    }
+
+    return lo;
+}
+
+typedef struct {
+    struct list_head *head, *tail;
+    size_t len;
+} run_t;
+
+/* Merge run @b into run @a, which holds the earlier nodes. Once either run
+ * wins MIN_GALLOP times in a row, the whole block of nodes it wins next is
+ * located with gallop() and linked at once.
+ */
+static void merge_gallop(run_t *a, const run_t *b, bool descend)
+{
+    struct list_head *x = a->head, *y = b->head;
+    struct list_head *head = NULL, **tail = &head;
+    int wins_x = 0, wins_y = 0;
+
+    while (x != NULL && y != NULL) {
+        struct list_head *last;
+
+        if (node_cmp(x, y, descend) <= 0) {
+            last = x;
+            if (++wins_x >= MIN_GALLOP) {
+                last = gallop(x, y, false, descend);
+                wins_x = 0;
+            }
+            wins_y = 0;
+            *tail = x;
+            x = last->next;
         } else {
-            list_del_init(&b->list);
-            list_add_tail(&b->list, &head);
+            last = y;
+            if (++wins_y >= MIN_GALLOP) {
+                last = gallop(y, x, true, descend);
+                wins_y = 0;
+            }
+            wins_x = 0;
+            *tail = y;
+            y = last->next;
         }
+        tail = &last->next;
     }
 
-    list_splice_tail_init(head_a, &head);
-    list_splice_tail_init(head_b, &head);
-    list_splice_tail_init(&head, head_a);
+    if (x != NULL) {
+        *tail = x;
+    } else {
+        *tail = y;
+        a->tail = b->tail;
+    }
+    a->head = head;
 }
 
-void list_mergesort(struct list_head *head, int size, bool descend)
+/* Detach the run at the start of @list into a null-terminated list. A
+ * strictly descending run is reversed on the way, which keeps it stable, and
+ * gets its prev pointers fixed as well.
+ */
+static void next_run(struct list_head **list, run_t *run, bool descend)
 {
-    if (list_empty(head) || list_is_singular(head)) {
+    struct list_head *cur = *list, *next = cur->next;
+
+    run->tail = cur;
+    run->len = 1;
+
+    if (next != NULL && node_cmp(next, cur, descend) < 0) {
+        cur->next = NULL;
+        do {
+            struct list_head *tmp = next->next;
+            next->next = cur;
+            cur->prev = next;
+            cur = next;
+            next = tmp;
+            run->len++;
+        } while (next != NULL && node_cmp(next, cur, descend) < 0);
+        run->head = cur;
+    } else {
+        run->head = cur;
+        while (next != NULL && node_cmp(next, cur, descend) >= 0) {
+            cur = next;
+            next = next->next;
+            run->len++;
+        }
+        cur->next = NULL;
+        run->tail = cur;
+    }
+
+    *list = next;
+}
+
+/* Merge the i-th and (i + 1)-th pending runs. Runs which do not overlap, as
+ * when a list sorted the other way is split at equal elements, are simply
+ * concatenated.
+ */
+static void merge_at(run_t *runs, int *n, int i, bool descend)
+{
+    run_t *a = &runs[i], *b = &runs[i + 1];
+
+    if (node_cmp(b->tail, a->head, descend) < 0) {
+        b->tail->next = a->head;
+        a->head = b->head;
+    } else if (node_cmp(a->tail, b->head, descend) <= 0) {
+        a->tail->next = b->head;
+        a->tail = b->tail;
+    } else {
+        merge_gallop(a, b, descend);
+    }
+    a->len += b->len;
+
+    if (i + 2 < *n) {
+        runs[i + 1] = runs[i + 2];
+    }
+    (*n)--;
+}
+
+/**
+ * natural_sort() - Sort a list by merging the runs it already contains
+ * @head: the list to sort
+ * @descend: whether or not to sort in descending order
+ *
+ * This follows the scheme of Timsort: runs are pushed on a stack and merged
+ * whenever the lengths of the three topmost runs break the invariants that
+ * keep merges balanced. The prev pointers are rebuilt at the end, unless the
+ * list is a single run: a sorted or strictly reverse-sorted list takes just
+ * one pass.
+ */
+static void natural_sort(struct list_head *head, bool descend)
+{
+    struct list_head *list = head->next;
+    run_t runs[MAX_PENDING_RUNS];
+    int n = 0;
+
+    if (list == head->prev) {
         return;
     }
 
-    struct list_head *node = head;
-    for (int i = 0; i < size / 2; i++) {
-        node = node->next;
+    head->prev->next = NULL;
+
+    next_run(&list, &runs[n++], descend);
+    if (list == NULL) {
+        /* The list was ordered already: only its ends need relinking */
+        runs[0].head->prev = head;
+        head->next = runs[0].head;
+        runs[0].tail->next = head;
+        head->prev = runs[0].tail;
+        return;
+    }
+
+    while (list != NULL) {
+        next_run(&list, &runs[n++], descend);
+
+        while (n > 1) {
+            int i = n - 2;
+            if ((i > 0 && runs[i - 1].len <= runs[i].len + runs[i + 1].len) ||
+                (i > 1 && runs[i - 2].len <= runs[i - 1].len + runs[i].len)) {
+                if (runs[i - 1].len < runs[i + 1].len) {
+                    i--;
+                }
+            } else if (runs[i].len > runs[i + 1].len) {
+                break;
+            }
+            merge_at(runs, &n, i, descend);
+        }
+    }
+
+    while (n > 1) {
+        int i = n - 2;
+        if (i > 0 && runs[i - 1].len < runs[i + 1].len) {
+            i--;
+        }
+        merge_at(runs, &n, i, descend);
+    }
+
+    struct list_head *prev = head;
+    head->next = runs[0].head;
+    for (list = runs[0].head; list != NULL; list = list->next) {
+        list->prev = prev;
+        prev = list;
+    }
+    prev->next = head;
+    head->prev = prev;
+}
+
+/* Lists shorter than this are not worth distributing into buckets */
+#define RADIX_CUTOFF 32
+
+/* Beyond this many bytes of common prefix, radix_sort() merge sorts */
+#define RADIX_MAX_DEPTH 32
+
+/* Get the byte at position @depth of the value of @node. Callers guarantee
+ * the value is at least @depth bytes long. */
+static inline unsigned char node_byte(const struct list_head *node,
+                                      unsigned int depth)
+{
+    const element_t *e = list_entry(node, element_t, list);
+    if (depth < 8) {
+        return e->key >> (56 - 8 * depth);
+    }
+
+    return e->value[depth];
+}
+
+/**
+ * radix_sort() - Sort a list with an MSD radix sort
+ * @head: the list to sort
+ * @size: the number of nodes in the list
+ * @depth: the length of the prefix every value in the list shares
+ * @descend: whether or not to sort in descending order
+ *
+ * The nodes are distributed into 256 buckets by their byte at @depth, and the
+ * buckets are sorted recursively and spliced back in order. Values ending at
+ * @depth land in bucket 0 and are equal, so it needs no further sorting. Small
+ * buckets, and values sharing very long prefixes, are merge sorted instead.
+ * Nodes are only relinked, and keep their relative order within a bucket, so
+ * the sort is stable and does not allocate.
+ */
+static void radix_sort(struct list_head *head,
+                       size_t size,
+                       unsigned int depth,
+                       bool descend)
+{
+    if (size < RADIX_CUTOFF || depth >= RADIX_MAX_DEPTH) {
+        list_sort(head, descend);
+        return;
+    }
+
+    struct list_head buckets[256];
+    size_t count[256] = {0};
+    for (int i = 0; i < 256; i++) {
+        INIT_LIST_HEAD(&buckets[i]);
+    }
+
+    struct list_head *node, *safe;
+    list_for_each_safe (node, safe, head) {
+        unsigned char b = node_byte(node, depth);
+        list_add_tail(node, &buckets[b]);
+        count[b]++;
+    }
+    INIT_LIST_HEAD(head);
+
+    for (int i = 0; i < 256; i++) {
+        int b = descend ? 255 - i : i;
+        if (count[b] == 0) {
+            continue;
+        }
+
+        if (b != 0 && count[b] > 1) {
+            radix_sort(&buckets[b], count[b], depth + 1, descend);
+        }
+        list_splice_tail(&buckets[b], head);
+    }
+}
+
+/* Sort a list with the algorithm selected by sort_mode */
+static void sort_list(struct list_head *head, size_t size, bool descend)
+{
+    if (sort_mode == SORT_NATURAL) {
+        natural_sort(head, descend);
+    } else if (sort_mode == SORT_RADIX) {
+        radix_sort(head, size, 0, descend);
+    } else {
+        list_sort(head, descend);
+    }
+}
+
+/* Merge the sorted list @b into the sorted list @a, taking ties from @a */
+static void merge_lists(struct list_head *a, struct list_head *b, bool descend)
+{
+    if (list_empty(b)) {
+        return;
+    }
+
+    if (list_empty(a)) {
+        list_splice_init(b, a);
+        return;
+    }
+
+    struct list_head *x = a->next, *y = b->next;
+    a->prev->next = NULL;
+    b->prev->next = NULL;
+    merge_final(a, x, y, descend);
+    INIT_LIST_HEAD(b);
+}
+
+/* Upper bound of worker_threads */
+#define MAX_THREADS 64
+
+/* Lists are not split among more threads than leave each this many nodes */
+#define PARALLEL_MIN_NODES 8192
+
+/**
+ * sort_task_t - A piece of work run by run_parallel()
+ * @head: list to sort, or to merge @other into
+ * @other: list to merge into @head, NULL to sort @head
+ * @size: the number of nodes in @head when sorting
+ * @descend: whether or not the order is descending
+ */
+typedef struct {
+    struct list_head *head, *other;
+    size_t size;
+    bool descend;
+} sort_task_t;
+
+static void *sort_worker(void *arg)
+{
+    const sort_task_t *task = arg;
+
+    if (task->other != NULL) {
+        merge_lists(task->head, task->other, task->descend);
+    } else {
+        sort_list(task->head, task->size, task->descend);
+    }
+
+    return NULL;
+}
+
+/* Run @n tasks concurrently, the first one on the calling thread. Workers
+ * block every signal, so SIGALRM of the time limit is still handled by the
+ * calling thread. A task whose thread cannot be created is run in place.
+ */
+static void run_parallel(sort_task_t *tasks, int n)
+{
+    pthread_t threads[MAX_THREADS];
+    bool spawned[MAX_THREADS];
+    sigset_t all, old;
+
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    for (int i = 1; i < n; i++) {
+        spawned[i] =
+            pthread_create(&threads[i], NULL, sort_worker, &tasks[i]) == 0;
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    sort_worker(&tasks[0]);
+
+    for (int i = 1; i < n; i++) {
+        if (spawned[i]) {
+            pthread_join(threads[i], NULL);
+        } else {
+            sort_worker(&tasks[i]);
+        }
+    }
+}
+
+/**
+ * parallel_sort() - Sort a list on several threads
+ * @head: the list to sort
+ * @size: the number of nodes in the list
+ * @n: the number of threads, at most MAX_THREADS
+ * @descend: whether or not to sort in descending order
+ *
+ * The list is cut into @n consecutive segments sorted concurrently, which are
+ * then merged pairwise, every round of the merge tree running its merges
+ * concurrently as well. Segments are merged with their right neighbour only,
+ * so the sort stays stable. Everything lives on the stack, nothing is
+ * allocated.
+ */
+static void parallel_sort(struct list_head *head,
+                          size_t size,
+                          int n,
+                          bool descend)
+{
+    struct list_head segs[MAX_THREADS];
+    sort_task_t tasks[MAX_THREADS];
+
+    for (int i = 0; i < n; i++) {
+        size_t len = size / n + ((size_t) i < size % n);
+        struct list_head *node = head;
+        for (size_t j = 0; j < len; j++) {
+            node = node->next;
+        }
+
+        INIT_LIST_HEAD(&segs[i]);
+        list_cut_position(&segs[i], head, node);
+        tasks[i] = (sort_task_t){&segs[i], NULL, len, descend};
     }
+    run_parallel(tasks, n);
 
-    struct list_head left;
-    INIT_LIST_HEAD(&left);
-    list_cut_position(&left, head, node);
+    for (int stride = 1; stride < n; stride <<= 1) {
+        int m = 0;
+        for (int i = 0; i + stride < n; i += 2 * stride) {
+            tasks[m++] = (sort_task_t){&segs[i], &segs[i + stride], 0, descend};
+        }
+        run_parallel(tasks, m);
+    }
 
-    list_mergesort(&left, size / 2, descend);
-    list_mergesort(head, size - size / 2, descend);
-    list_merge(head, &left, descend);
+    list_splice(&segs[0], head);
 }
 
+int sort_mode = SORT_MERGE;
+int worker_threads = 1;
+
 /* Sort elements of queue in ascending/descending order */
 void q_sort(struct list_head *head, bool descend)
 {
     if (head == NULL) {
         return;
     }
+    queue_of(head)->mid = NULL;
+
+    size_t size = queue_of(head)->size;
+    int n = worker_threads < MAX_THREADS ? worker_threads : MAX_THREADS;
+    if ((size_t) n > size / PARALLEL_MIN_NODES) {
+        n = size / PARALLEL_MIN_NODES;
+    }
 
-    list_mergesort(head, q_size(head), descend);
+    if (n > 1) {
+        parallel_sort(head, size, n, descend);
+    } else {
+        sort_list(head, size, descend);
+    }
 }
 
 
-/* Remove every node which has a node with a strictly less value anywhere to
- * the right side of it */
-int q_ascend(struct list_head *head)
+/**
+ * remove_dominated() - Remove every node with a node ordered before it on its
+ * right side
+ * @head: header of queue
+ * @descend: whether nodes are ordered from the greatest value
+ *
+ * The queue is scanned once from its tail. The last node kept is the smallest
+ * (greatest) value seen so far, so a node is removed exactly when it compares
+ * greater (less) than that one. Removed nodes are collected on a list of their
+ * own and released once the scan is over.
+ *
+ * Return: the number of nodes kept
+ */
+static int remove_dominated(struct list_head *head, bool descend)
 {
-    // https://leetcode.com/problems/remove-nodes-from-linked-list/
-    if (head == NULL) {
+    queue_head_t *q = queue_of(head);
+    q->mid = NULL;
+    if (list_empty(head)) {
         return 0;
     }
 
-    if (q_size(head) <= 1) {
-        return q_size(head);
-    }
+    LIST_HEAD(removed);
+    const element_t *last = list_last_entry(head, element_t, list);
+    struct list_head *cur = head->prev->prev;
+    int kept = 1;
+    while (cur != head) {
+        element_t *node = list_entry(cur, element_t, list);
+        cur = cur->prev;
 
-    const struct list_head *end = head;
-    struct list_head *cur = head->next->next;
-    while (cur != end) {
-        if (cur->prev == head) {
-            cur = cur->next;
-            continue;
+        int cmp = element_cmp(node, last);
+        if (descend ? cmp < 0 : cmp > 0) {
+            list_move(&node->list, &removed);
+        } else {
+            last = node;
+            kept++;
         }
+    }
 
-        const element_t *a = list_entry(cur, element_t, list);
-        element_t *b = list_entry(cur->prev, element_t, list);
+    element_t *node, *safe;
+    list_for_each_entry_safe (node, safe, &removed, list) {
+        q_release_element(node);
+    }
+    q->size = kept;
+    return kept;
+}
 
-        if (strcmp(a->value, b->value) < 0) {
-            list_del_init(&b->list);
-            q_release_element(b);
-        } else {
-            cur = cur->next;
-        }
+/* Remove every node which has a node with a strictly less value anywhere to
+ * the right side of it */
+int q_ascend(struct list_head *head)
+{
+    // https://leetcode.com/problems/remove-nodes-from-linked-list/
+    if (head == NULL) {
+        return 0;
     }
 
-    return q_size(head);
+    return remove_dominated(head, false);
 }
 
 /* Remove every node which has a node with a strictly greater value anywhere to
@@ -393,32 +1360,116 @@ int q_descend(struct list_head *head)
         return 0;
     }
 
-    if (q_size(head) <= 1) {
-        return q_size(head);
+    return remove_dominated(head, true);
+}
+
+/* Merge queue @b into queue @a, which comes first in the chain */
+static void merge_queues(struct list_head *a, struct list_head *b, bool descend)
+{
+    merge_lists(a, b, descend);
+    queue_of(a)->size += queue_of(b)->size;
+    queue_of(b)->size = 0;
+}
+
+/* Maximum number of queues merge_heap() merges at once */
+#define MERGE_HEAP_MAX 256
+
+typedef struct {
+    struct list_head *node; /* next node to take from the queue */
+    struct list_head *head; /* head of the queue */
+    int order;              /* position of the queue, to break ties */
+} heap_entry_t;
+
+static inline bool heap_less(const heap_entry_t *a,
+                             const heap_entry_t *b,
+                             bool descend)
+{
+    int cmp = node_cmp(a->node, b->node, descend);
+    return cmp < 0 || (cmp == 0 && a->order < b->order);
+}
+
+static void heap_sift_down(heap_entry_t *heap, int n, int i, bool descend)
+{
+    heap_entry_t entry = heap[i];
+
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= n) {
+            break;
+        }
+        if (child + 1 < n &&
+            heap_less(&heap[child + 1], &heap[child], descend)) {
+            child++;
+        }
+        if (!heap_less(&heap[child], &entry, descend)) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
     }
+    heap[i] = entry;
+}
 
-    const struct list_head *end = head;
-    struct list_head *cur = head->next->next;
-    while (cur != end) {
-        if (cur->prev == head) {
-            cur = cur->next;
-            continue;
+/**
+ * merge_heap() - Merge sorted queues with a min-heap of their first nodes
+ * @queues: the queues, in chain order
+ * @k: the number of queues, at most MERGE_HEAP_MAX
+ * @descend: whether the queues are sorted in descending order
+ *
+ * Every node goes through the heap once, so merging N nodes costs
+ * O(N log k) comparisons. Ties go to the earlier queue. When a single queue
+ * is left, the rest of it is linked at once. Everything ends in @queues[0].
+ */
+static void merge_heap(struct list_head **queues, int k, bool descend)
+{
+    heap_entry_t heap[MERGE_HEAP_MAX];
+    int n = 0, size = 0;
+
+    for (int i = 0; i < k; i++) {
+        if (!list_empty(queues[i])) {
+            heap[n++] = (heap_entry_t){queues[i]->next, queues[i], i};
         }
+        size += queue_of(queues[i])->size;
+    }
 
-        const element_t *a = list_entry(cur, element_t, list);
-        element_t *b = list_entry(cur->prev, element_t, list);
+    for (int i = n / 2 - 1; i >= 0; i--) {
+        heap_sift_down(heap, n, i, descend);
+    }
+
+    LIST_HEAD(merged);
+    while (n > 1) {
+        struct list_head *node = heap[0].node, *next = node->next;
 
-        if (strcmp(a->value, b->value) > 0) {
-            list_del_init(&b->list);
-            q_release_element(b);
+        list_add_tail(node, &merged);
+        if (next != heap[0].head) {
+            heap[0].node = next;
         } else {
-            cur = cur->next;
+            heap[0] = heap[--n];
         }
+        heap_sift_down(heap, n, 0, descend);
     }
 
-    return q_size(head);
+    if (n == 1) {
+        struct list_head *first = heap[0].node, *last = heap[0].head->prev;
+
+        first->prev = merged.prev;
+        merged.prev->next = first;
+        last->next = &merged;
+        merged.prev = last;
+    }
+
+    for (int i = 0; i < k; i++) {
+        INIT_LIST_HEAD(queues[i]);
+        queue_of(queues[i])->size = 0;
+    }
+    list_splice(&merged, queues[0]);
+    queue_of(queues[0])->size = size;
 }
 
+int merge_mode = MERGE_HEAP;
+double merge_round_time[MERGE_MAX_ROUNDS];
+int merge_rounds;
+
 /* Merge all the queues into one sorted queue, which is in ascending/descending
  * order */
 int q_merge(struct list_head *head, bool descend)
@@ -435,14 +1486,80 @@ int q_merge(struct list_head *head, bool descend)
 
     const queue_contex_t *first =
         list_first_entry(&ctx->chain, queue_contex_t, chain);
-
     queue_contex_t *cur = NULL;
+    int k = ctx->size;
     list_for_each_entry (cur, &ctx->chain, chain) {
-        if (cur == first) {
-            continue;
+        queue_of(cur->q)->mid = NULL;
+    }
+
+    if (merge_mode == MERGE_PAIRWISE) {
+        /* Merge the queues 2^r apart in round r, like a bottom-up merge
+         * sort, so every node takes part in about log k merges. The pairs
+         * of a round are disjoint, so up to worker_threads of them are
+         * merged at once. */
+        int n = worker_threads < MAX_THREADS ? worker_threads : MAX_THREADS;
+        if (n < 1) {
+            n = 1;
         }
+        sort_task_t tasks[MAX_THREADS];
+        merge_rounds = 0;
+        for (int stride = 1; stride < k; stride <<= 1) {
+            struct timespec start, end;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+
+            const queue_contex_t *left = NULL;
+            int pos = 0, m = 0;
+            list_for_each_entry (cur, &ctx->chain, chain) {
+                if (pos % (2 * stride) == 0) {
+                    left = cur;
+                } else if (pos % (2 * stride) == stride) {
+                    queue_of(left->q)->size += queue_of(cur->q)->size;
+                    queue_of(cur->q)->size = 0;
+                    tasks[m++] = (sort_task_t){left->q, cur->q, 0, descend};
+                    if (m == n) {
+                        run_parallel(tasks, m);
+                        m = 0;
+                    }
+                }
+                pos++;
+            }
+            if (m > 0) {
+                run_parallel(tasks, m);
+            }
 
-        list_merge(first->q, cur->q, descend);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            if (merge_rounds < MERGE_MAX_ROUNDS) {
+                merge_round_time[merge_rounds++] =
+                    (end.tv_sec - start.tv_sec) +
+                    (end.tv_nsec - start.tv_nsec) * 1e-9;
+            }
+        }
+    } else if (merge_mode == MERGE_HEAP) {
+        /* Merge groups of up to MERGE_HEAP_MAX queues into their first
+         * queue, then the groups the same way until one queue is left */
+        struct list_head *group[MERGE_HEAP_MAX];
+        for (int stride = 1; stride < k; stride *= MERGE_HEAP_MAX) {
+            int pos = 0, n = 0;
+            list_for_each_entry (cur, &ctx->chain, chain) {
+                if (pos++ % stride != 0) {
+                    continue;
+                }
+                group[n++] = cur->q;
+                if (n == MERGE_HEAP_MAX) {
+                    merge_heap(group, n, descend);
+                    n = 0;
+                }
+            }
+            if (n > 1) {
+                merge_heap(group, n, descend);
+            }
+        }
+    } else {
+        list_for_each_entry (cur, &ctx->chain, chain) {
+            if (cur != first) {
+                merge_queues(first->q, cur->q, descend);
+            }
+        }
     }
 
     return q_size(first->q);
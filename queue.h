@@ -9,22 +9,53 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "harness.h"
 #include "list.h"
 
+/* Strings up to this size, including the terminator, are stored inline */
+#define ELEMENT_INLINE_SIZE 24
+
 /**
  * element_t - Linked list element
  * @value: pointer to array holding string
  * @list: node of a doubly-linked list
+ * @key: the first 8 bytes of @value packed in big-endian order
+ * @inline_value: storage for short strings
  *
- * @value needs to be explicitly allocated and freed
+ * @value points to @inline_value when the string fits in it, otherwise it
+ * needs to be explicitly allocated and freed. @key is zero-padded past the
+ * terminator, so comparing keys as integers orders them like strcmp() does.
  */
 typedef struct {
     char *value;
     struct list_head list;
+    uint64_t key;
+    char inline_value[ELEMENT_INLINE_SIZE];
 } element_t;
 
+/**
+ * queue_head_t - The head of a queue
+ * @head: list head linking the elements, as returned by q_new()
+ * @mid: the node at index @size / 2, NULL if unknown
+ * @size: the number of elements in the queue
+ *
+ * @size is maintained by every operation which links or unlinks elements, so
+ * q_size() runs in constant time. @mid is only maintained in indexed mode, by
+ * insertions and removals at either end and by q_delete_mid(); operations
+ * which reorder the queue reset it.
+ */
+typedef struct {
+    struct list_head head;
+    struct list_head *mid;
+    int size;
+} queue_head_t;
+
+/* Whether queues track their middle node, so q_delete_mid() runs in constant
+ * time */
+extern int queue_indexed;
+
 /**
  * queue_contex_t - The context managing a chain of queues
  * @q: pointer to the head of the queue
@@ -78,6 +109,34 @@ bool q_insert_head(struct list_head *head, char *s);
  */
 bool q_insert_tail(struct list_head *head, char *s);
 
+/**
+ * q_insert_head_bulk() - Insert several elements in the head
+ * @head: header of queue
+ * @s: array of the strings would be inserted
+ * @n: the number of strings
+ *
+ * Same as calling q_insert_head() on s[0] to s[n-1] in turn, so s[n-1] ends up
+ * at the head, except that either every string is inserted or none is. The
+ * elements are linked into a chain of their own, which is spliced into the
+ * queue at once.
+ *
+ * Return: true for success, false for allocation failed or queue is NULL
+ */
+bool q_insert_head_bulk(struct list_head *head, char **s, int n);
+
+/**
+ * q_insert_tail_bulk() - Insert several elements at the tail
+ * @head: header of queue
+ * @s: array of the strings would be inserted
+ * @n: the number of strings
+ *
+ * Same as calling q_insert_tail() on s[0] to s[n-1] in turn, so s[n-1] ends up
+ * at the tail, except that either every string is inserted or none is.
+ *
+ * Return: true for success, false for allocation failed or queue is NULL
+ */
+bool q_insert_tail_bulk(struct list_head *head, char **s, int n);
+
 /**
  * q_remove_head() - Remove the element from head of queue
  * @head: header of queue
@@ -108,17 +167,55 @@ element_t *q_remove_head(struct list_head *head, char *sp, size_t bufsize);
  */
 element_t *q_remove_tail(struct list_head *head, char *sp, size_t bufsize);
 
+/**
+ * q_move_range() - Move a range of elements to the tail of another queue
+ * @from: header of the queue the elements are taken from
+ * @to: header of the queue the elements are appended to
+ * @i: position of the first element to move, counting from 0
+ * @j: position just past the last element to move
+ *
+ * The elements at positions [@i, @j) of @from keep their order and end up at
+ * the tail of @to, which may be @from itself. The range is clamped to the
+ * queue. Only the cut points are searched for, walking from the nearer end,
+ * after which the range is spliced at once, so no element is allocated or
+ * freed.
+ *
+ * Return: the number of elements moved, zero if either queue is NULL
+ */
+int q_move_range(struct list_head *from, struct list_head *to, int i, int j);
+
+/**
+ * q_move_head() - Move the first elements to the tail of another queue
+ * @from: header of the queue the elements are taken from
+ * @to: header of the queue the elements are appended to
+ * @n: the number of elements
+ *
+ * Same as q_move_range() on positions [0, @n).
+ *
+ * Return: the number of elements moved, zero if either queue is NULL
+ */
+int q_move_head(struct list_head *from, struct list_head *to, int n);
+
+/**
+ * q_move_tail() - Move the last elements to the tail of another queue
+ * @from: header of the queue the elements are taken from
+ * @to: header of the queue the elements are appended to
+ * @n: the number of elements
+ *
+ * Same as q_move_range() on the last @n positions.
+ *
+ * Return: the number of elements moved, zero if either queue is NULL
+ */
+int q_move_tail(struct list_head *from, struct list_head *to, int n);
+
 /**
  * q_release_element() - Release the element
  * @e: element would be released
  *
- * This function is intended for internal use only.
+ * Elements are allocated from a pool of chunks, so @e must not be handed to
+ * free() directly. This function is intended for internal use only.
  */
-static inline void q_release_element(element_t *e)
-{
-    test_free(e->value);
-    test_free(e);
-}
+void q_release_element(element_t *e);
 
 /**
  * q_size() - Get the size of the queue
@@ -135,6 +232,8 @@ int q_size(struct list_head *head);
  * The middle node of a linked list of size n is the
  * ⌊n / 2⌋th node from the start using 0-based indexing.
  * If there're six elements, the third member should be returned.
+ * In indexed mode the middle node is usually known, otherwise half of the
+ * queue is walked to find it.
  *
  * Reference:
  * https://leetcode.com/problems/delete-the-middle-node-of-a-linked-list/
@@ -143,15 +242,30 @@ int q_size(struct list_head *head);
  */
 bool q_delete_mid(struct list_head *head);
 
+/* Ways q_delete_dup() can find duplicates */
+enum {
+    DEDUP_ADJACENT, /* runs of equal strings, the queue is sorted */
+    DEDUP_HASH,     /* equal strings anywhere, through a hash table */
+};
+
+/* Way used by q_delete_dup(), one of the DEDUP_* values */
+extern int dedup_mode;
+
 /**
  * q_delete_dup() - Delete all nodes that have duplicate string,
  *                  leaving only distinct strings from the original queue.
  * @head: header of queue
  *
+ * In DEDUP_ADJACENT mode only equal strings next to each other are found, so
+ * the queue should be sorted first. In DEDUP_HASH mode the queue may be in any
+ * order; a table of its strings is allocated, and the remaining elements keep
+ * their relative order.
+ *
  * Reference:
  * https://leetcode.com/problems/remove-duplicates-from-sorted-list-ii/
  *
- * Return: true for success, false if list is NULL or empty.
+ * Return: true for success, false if list is NULL or the table of DEDUP_HASH
+ * mode cannot be allocated.
  */
 bool q_delete_dup(struct list_head *head);
 
@@ -190,13 +304,27 @@ void q_reverse(struct list_head *head);
  */
 void q_reverseK(struct list_head *head, int k);
 
+/* Algorithms q_sort() can use */
+enum {
+    SORT_MERGE,   /* bottom-up merge sort */
+    SORT_NATURAL, /* merge sort over the runs already present in the queue */
+    SORT_RADIX,   /* MSD radix sort on the bytes of the values */
+};
+
+/* Algorithm used by q_sort(), one of the SORT_* values */
+extern int sort_mode;
+
+/* Number of threads q_sort() may use, the queue is sorted in place if 1 */
+extern int worker_threads;
+
 /**
  * q_sort() - Sort elements of queue in ascending/descending order
  * @head: header of queue
  * @descend: whether or not to sort in descending order
  *
  * No effect if queue is NULL or empty. If there has only one element, do
- * nothing.
+ * nothing. The sort is stable whichever algorithm sort_mode selects, and
+ * however many threads it runs on.
  */
 void q_sort(struct list_head *head, bool descend);
 
@@ -232,6 +360,22 @@ int q_ascend(struct list_head *head);
  */
 int q_descend(struct list_head *head);
 
+/* Strategies q_merge() can use */
+enum {
+    MERGE_SEQUENTIAL, /* merge every queue into the first one in turn */
+    MERGE_HEAP,       /* k-way merge through a min-heap of the queues */
+    MERGE_PAIRWISE,   /* merge neighbouring queues in log k rounds */
+};
+
+/* Strategy used by q_merge(), one of the MERGE_* values */
+extern int merge_mode;
+
+/* Wall-clock seconds spent in each round of the last MERGE_PAIRWISE merge,
+ * which runs up to worker_threads merges of a round at once */
+#define MERGE_MAX_ROUNDS 32
+extern double merge_round_time[MERGE_MAX_ROUNDS];
+extern int merge_rounds;
+
 /**
  * q_merge() - Merge all the queues into one sorted queue, which is in
  * ascending/descending order.
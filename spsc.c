@@ -0,0 +1,73 @@
+#include "spsc.h"
+#include <stdlib.h>
+
+#include "harness.h"
+
+/* Create an empty queue */
+spsc_t *spsc_new(size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    spsc_t *q = malloc(sizeof(spsc_t));
+    if (q == NULL) {
+        return NULL;
+    }
+
+    q->slots = malloc(sizeof(void *) * size);
+    if (q->slots == NULL) {
+        free(q);
+        return NULL;
+    }
+
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    q->tail_cache = q->head_cache = 0;
+    q->mask = size - 1;
+    return q;
+}
+
+/* Free all storage used by queue */
+void spsc_free(spsc_t *q)
+{
+    if (q == NULL) {
+        return;
+    }
+
+    free(q->slots);
+    free(q);
+}
+
+/* Push an item, called by the producer thread only */
+bool spsc_push(spsc_t *q, void *item)
+{
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if (tail - q->head_cache > q->mask) {
+        q->head_cache = atomic_load_explicit(&q->head, memory_order_acquire);
+        if (tail - q->head_cache > q->mask) {
+            return false;
+        }
+    }
+
+    q->slots[tail & q->mask] = item;
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+/* Pop the oldest item, called by the consumer thread only */
+void *spsc_pop(spsc_t *q)
+{
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if (head == q->tail_cache) {
+        q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+        if (head == q->tail_cache) {
+            return NULL;
+        }
+    }
+
+    void *item = q->slots[head & q->mask];
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return item;
+}
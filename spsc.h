@@ -0,0 +1,78 @@
+#ifndef LAB0_SPSC_H
+#define LAB0_SPSC_H
+
+/* This program implements a lock-free bounded queue for exactly one producer
+ * thread and one consumer thread.
+ *
+ * Items are pointers stored in a ring. The producer owns the tail index and
+ * the consumer the head index; each publishes its index with a release store
+ * and reads the other one with an acquire load, which orders the accesses to
+ * the slots. Each side also caches the index of the other side, so it only
+ * touches the cache line of the other index when the ring looks full (empty).
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cacheline.h"
+
+/**
+ * spsc_t - Single-producer/single-consumer bounded queue
+ * @head: index of the next slot to pop, written by the consumer only
+ * @tail_cache: the consumer's last view of @tail
+ * @tail: index of the next slot to push, written by the producer only
+ * @head_cache: the producer's last view of @head
+ * @mask: the number of slots minus one
+ * @slots: the ring of items
+ *
+ * Indices grow without wrapping around the ring; the slot of index i is
+ * i & @mask. The padding keeps the fields of each side on cache lines of
+ * their own, however the structure is aligned.
+ */
+typedef struct {
+    atomic_size_t head;
+    size_t tail_cache;
+    char pad_head[CACHE_LINE_SIZE];
+    atomic_size_t tail;
+    size_t head_cache;
+    char pad_tail[CACHE_LINE_SIZE];
+    size_t mask;
+    void **slots;
+} spsc_t;
+
+/**
+ * spsc_new() - Create an empty queue
+ * @capacity: the least number of items the queue must hold, rounded up to a
+ * power of two
+ *
+ * Return: NULL for allocation failed
+ */
+spsc_t *spsc_new(size_t capacity);
+
+/**
+ * spsc_free() - Free all storage used by queue, no effect if @q is NULL
+ * @q: the queue, which no thread may be using any more
+ *
+ * The items left in the queue are not freed.
+ */
+void spsc_free(spsc_t *q);
+
+/**
+ * spsc_push() - Push an item, called by the producer thread only
+ * @q: the queue
+ * @item: the item, which must not be NULL
+ *
+ * Return: true for success, false if the queue is full
+ */
+bool spsc_push(spsc_t *q, void *item);
+
+/**
+ * spsc_pop() - Pop the oldest item, called by the consumer thread only
+ * @q: the queue
+ *
+ * Return: the item, NULL if the queue is empty
+ */
+void *spsc_pop(spsc_t *q);
+
+#endif /* LAB0_SPSC_H */
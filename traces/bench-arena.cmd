@@ -0,0 +1,15 @@
+# Benchmark of the allocator on 1M strings too long to be stored inline,
+# from malloc, from fresh slabs, then from blocks freed back to the slabs
+option fail 0
+option malloc 0
+option timeout 10
+new
+time ih a-string-too-long-to-be-stored-inline 1000000
+time free
+option arena 1
+new
+time ih a-string-too-long-to-be-stored-inline 1000000
+time free
+new
+time ih a-string-too-long-to-be-stored-inline 1000000
+time free
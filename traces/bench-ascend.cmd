@@ -0,0 +1,20 @@
+# Benchmark of ascend and descend on 1M strings
+option fail 0
+option malloc 0
+option timeout 10
+# Most nodes are removed from a random queue
+new
+ih RAND 1000000
+time ascend
+free
+new
+ih RAND 1000000
+time descend
+free
+# Every node is kept by ascend on an ascending queue, and removed by descend
+new
+ih RAND 1000000
+sort
+time ascend
+time descend
+free
@@ -0,0 +1,20 @@
+# Benchmark of removing duplicates from 1M unsorted strings. The times include
+# the checks of qtest, which sort a copy of the queue in hash table mode
+option fail 0
+option malloc 0
+option timeout 10
+# Sort first, then remove runs of equal strings
+option dedup 0
+new
+ih RAND 500000
+ih dup 500000
+time sort
+time dedup
+free
+# Remove equal strings anywhere through a hash table
+option dedup 1
+new
+ih RAND 500000
+ih dup 500000
+time dedup
+free
@@ -0,0 +1,8 @@
+# Benchmark of freeing 1M strings in random order, checking every block freed
+option fail 0
+option malloc 0
+option timeout 10
+new
+ih RAND 1000000
+time sort
+time free
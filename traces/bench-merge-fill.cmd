@@ -0,0 +1,3 @@
+new
+ih RAND 2000
+sort
@@ -0,0 +1,25 @@
+# Benchmark of the merging strategies on 128 queues of 2000 random strings
+option fail 0
+option malloc 0
+option timeout 10
+# bench-merge-fill.cmd creates one sorted queue of 2000 random strings
+# Merge every queue into the first one in turn
+option merge 0
+repeat 128 source traces/bench-merge-fill.cmd
+time merge
+free
+# K-way merge through a min-heap
+option merge 1
+repeat 128 source traces/bench-merge-fill.cmd
+time merge
+free
+# Merge neighbouring queues in log k rounds
+option merge 2
+repeat 128 source traces/bench-merge-fill.cmd
+time merge
+free
+# The same rounds with the merges of each round on 4 threads
+option threads 4
+repeat 128 source traces/bench-merge-fill.cmd
+time merge
+free
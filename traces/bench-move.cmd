@@ -0,0 +1,18 @@
+# Benchmark of moving ranges of 1M strings between two queues
+option fail 0
+option malloc 0
+option timeout 10
+new
+new
+ih RAND 1000000
+time mh 0 500000
+time mt 0 250000
+time mr 0 100000 900000
+next
+time mr 1 0 1000000
+next
+time mh 0 1
+time mt 0 1
+time mr 0 499999 500001
+free
+free
@@ -0,0 +1,3 @@
+# Benchmark of the lock-free queue and a locked list, from 1 to 16 producer
+# and consumer threads
+mpmc 1000000 16
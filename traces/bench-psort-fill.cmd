@@ -0,0 +1,2 @@
+new
+ih RAND 50000
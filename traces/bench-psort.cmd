@@ -0,0 +1,14 @@
+# Benchmark of sorting 16 queues of 50000 random strings on 1, 2 and 4 workers
+option fail 0
+option malloc 0
+option timeout 10
+# bench-psort-fill.cmd creates one queue of 50000 random strings
+repeat 16 source traces/bench-psort-fill.cmd
+psort 1
+repeat 16 free
+repeat 16 source traces/bench-psort-fill.cmd
+psort 2
+repeat 16 free
+repeat 16 source traces/bench-psort-fill.cmd
+psort 4
+repeat 16 free
@@ -0,0 +1,13 @@
+# Benchmark of reverseK on 1M strings, for group sizes from 2 to 1e5
+option fail 0
+option malloc 0
+option timeout 10
+new
+ih RAND 1000000
+time reverseK 2
+time reverseK 10
+time reverseK 100
+time reverseK 1000
+time reverseK 10000
+time reverseK 100000
+free
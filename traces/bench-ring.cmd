@@ -0,0 +1,7 @@
+# Benchmark of head and tail operations on a queue and on a ring-buffer deque
+option fail 0
+option malloc 0
+option timeout 10
+ring 1000
+ring 100000
+ring 1000000
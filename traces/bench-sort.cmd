@@ -0,0 +1,29 @@
+# Benchmark of the sorting algorithms on two million random strings
+option fail 0
+option malloc 0
+option timeout 10
+# Merge sort
+option sort 0
+new
+ih RAND 2000000
+time sort
+free
+# Natural merge sort
+option sort 1
+new
+ih RAND 2000000
+time sort
+free
+# Radix sort
+option sort 2
+new
+ih RAND 2000000
+time sort
+free
+# Merge sort on four threads
+option sort 0
+option threads 4
+new
+ih RAND 2000000
+time sort
+free
@@ -0,0 +1,4 @@
+# Benchmark of the lock-free queue between a producer and a consumer thread
+spsc 1000000 64
+spsc 1000000 1024
+spsc 1000000 65536
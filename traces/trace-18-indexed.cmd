@@ -0,0 +1,127 @@
+# Test of delete_mid with the middle node tracked, mixed with insert_head,
+# insert_tail, remove_head and remove_tail
+option fail 0
+option malloc 0
+option indexed 1
+new
+ih yak
+it pig
+ih jay
+it ibis
+it ram
+dm
+rh jay
+rt ram
+ih hen
+ih ram
+dm
+rh ram
+rh hen
+ih jay
+ih mole
+dm
+it toad
+it ibis
+ih dog
+ih ram
+dm
+dm
+it gnu
+rh ram
+ih ram
+ih zebu
+it koi
+rh zebu
+dm
+ih pig
+ih cat
+ih lynx
+rt koi
+dm
+dm
+rh lynx
+dm
+it eel
+rh cat
+it mole
+ih newt
+dm
+dm
+ih koi
+rh koi
+ih eel
+dm
+rh eel
+rh newt
+it fox
+rh mole
+it ant
+it owl
+it vole
+ih mole
+it newt
+rh mole
+dm
+it fox
+dm
+it bat
+it lynx
+dm
+rt lynx
+ih gnu
+it toad
+dm
+ih jay
+ih lynx
+dm
+rt toad
+dm
+it newt
+it ram
+it newt
+ih ibis
+ih jay
+it yak
+it koi
+it seal
+ih cat
+it owl
+rt owl
+ih cat
+rh cat
+rt seal
+it ram
+rh cat
+dm
+it ant
+rt ant
+rh jay
+dm
+ih cat
+dm
+dm
+ih ibis
+it zebu
+ih eel
+dm
+ih ram
+rt zebu
+ih ibis
+rh ibis
+dm
+dm
+it ram
+dm
+ih vole
+rh vole
+size
+dm
+dm
+dm
+dm
+dm
+dm
+dm
+dm
+size
+free
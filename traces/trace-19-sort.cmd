@@ -0,0 +1,280 @@
+# Test of the sorting algorithms, ascending and descending, on one and two
+# threads, including values sharing prefixes
+option fail 0
+option malloc 0
+option sort 0
+option threads 1
+option descend 0
+new
+it bear
+ih ant
+it beard
+ih be
+it zebra
+ih bears
+it ant
+sort
+rh ant
+rh ant
+rh be
+rh bear
+rh beard
+rh bears
+rh zebra
+ih RAND 20000
+sort
+reverse
+sort
+free
+option descend 1
+new
+it bear
+ih ant
+it beard
+ih be
+it zebra
+ih bears
+it ant
+sort
+rh zebra
+rh bears
+rh beard
+rh bear
+rh be
+rh ant
+rh ant
+ih RAND 20000
+sort
+reverse
+sort
+free
+option sort 0
+option threads 2
+option descend 0
+new
+it bear
+ih ant
+it beard
+ih be
+it zebra
+ih bears
+it ant
+sort
+rh ant
+rh ant
+rh be
+rh bear
+rh beard
+rh bears
+rh zebra
+ih RAND 20000
+sort
+reverse
+sort
+free
+option descend 1
+new
+it bear
+ih ant
+it beard
+ih be
+it zebra
+ih bears
+it ant
+sort
+rh zebra
+rh bears
+rh beard
+rh bear
+rh be
+rh ant
+rh ant
+ih RAND 20000
+sort
+reverse
+sort
+free
+option sort 1
+option threads 1
+option descend 0
+new
+it bear
+ih ant
+it beard
+ih be
+it zebra
+ih bears
+it ant
+sort
+rh ant
+rh ant
+rh be
+rh bear
+rh beard
+rh bears
+rh zebra
+ih RAND 20000
+sort
+reverse
+sort
+free
+option descend 1
+new
+it bear
+ih ant
+it beard
+ih be
+it zebra
+ih bears
+it ant
+sort
+rh zebra
+rh bears
+rh beard
+rh bear
+rh be
+rh ant
+rh ant
+ih RAND 20000
+sort
+reverse
+sort
+free
+option sort 1
+option threads 2
+option descend 0
+new
+it bear
+ih ant
+it beard
+ih be
+it zebra
+ih bears
+it ant
+sort
+rh ant
+rh ant
+rh be
+rh bear
+rh beard
+rh bears
+rh zebra
+ih RAND 20000
+sort
+reverse
+sort
+free
+option descend 1
+new
+it bear
+ih ant
+it beard
+ih be
+it zebra
+ih bears
+it ant
+sort
+rh zebra
+rh bears
+rh beard
+rh bear
+rh be
+rh ant
+rh ant
+ih RAND 20000
+sort
+reverse
+sort
+free
+option sort 2
+option threads 1
+option descend 0
+new
+it bear
+ih ant
+it beard
+ih be
+it zebra
+ih bears
+it ant
+sort
+rh ant
+rh ant
+rh be
+rh bear
+rh beard
+rh bears
+rh zebra
+ih RAND 20000
+sort
+reverse
+sort
+free
+option descend 1
+new
+it bear
+ih ant
+it beard
+ih be
+it zebra
+ih bears
+it ant
+sort
+rh zebra
+rh bears
+rh beard
+rh bear
+rh be
+rh ant
+rh ant
+ih RAND 20000
+sort
+reverse
+sort
+free
+option sort 2
+option threads 2
+option descend 0
+new
+it bear
+ih ant
+it beard
+ih be
+it zebra
+ih bears
+it ant
+sort
+rh ant
+rh ant
+rh be
+rh bear
+rh beard
+rh bears
+rh zebra
+ih RAND 20000
+sort
+reverse
+sort
+free
+option descend 1
+new
+it bear
+ih ant
+it beard
+ih be
+it zebra
+ih bears
+it ant
+sort
+rh zebra
+rh bears
+rh beard
+rh bear
+rh be
+rh ant
+rh ant
+ih RAND 20000
+sort
+reverse
+sort
+free
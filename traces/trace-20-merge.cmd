@@ -0,0 +1,412 @@
+# Test of the merging strategies, ascending and descending, with the pairwise
+# merges on one and two threads
+option fail 0
+option malloc 0
+option merge 0
+option threads 1
+option descend 0
+new
+it gerbil
+it ant
+it fox
+sort
+new
+it be
+it bear
+sort
+new
+new
+it zebra
+it ant
+it beard
+sort
+new
+it fox
+sort
+merge
+rh ant
+rh ant
+rh be
+rh bear
+rh beard
+rh fox
+rh fox
+rh gerbil
+rh zebra
+free
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+merge
+free
+option descend 1
+new
+it gerbil
+it ant
+it fox
+sort
+new
+it be
+it bear
+sort
+new
+new
+it zebra
+it ant
+it beard
+sort
+new
+it fox
+sort
+merge
+rh zebra
+rh gerbil
+rh fox
+rh fox
+rh beard
+rh bear
+rh be
+rh ant
+rh ant
+free
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+merge
+free
+option merge 1
+option threads 1
+option descend 0
+new
+it gerbil
+it ant
+it fox
+sort
+new
+it be
+it bear
+sort
+new
+new
+it zebra
+it ant
+it beard
+sort
+new
+it fox
+sort
+merge
+rh ant
+rh ant
+rh be
+rh bear
+rh beard
+rh fox
+rh fox
+rh gerbil
+rh zebra
+free
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+merge
+free
+option descend 1
+new
+it gerbil
+it ant
+it fox
+sort
+new
+it be
+it bear
+sort
+new
+new
+it zebra
+it ant
+it beard
+sort
+new
+it fox
+sort
+merge
+rh zebra
+rh gerbil
+rh fox
+rh fox
+rh beard
+rh bear
+rh be
+rh ant
+rh ant
+free
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+merge
+free
+option merge 2
+option threads 1
+option descend 0
+new
+it gerbil
+it ant
+it fox
+sort
+new
+it be
+it bear
+sort
+new
+new
+it zebra
+it ant
+it beard
+sort
+new
+it fox
+sort
+merge
+rh ant
+rh ant
+rh be
+rh bear
+rh beard
+rh fox
+rh fox
+rh gerbil
+rh zebra
+free
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+merge
+free
+option descend 1
+new
+it gerbil
+it ant
+it fox
+sort
+new
+it be
+it bear
+sort
+new
+new
+it zebra
+it ant
+it beard
+sort
+new
+it fox
+sort
+merge
+rh zebra
+rh gerbil
+rh fox
+rh fox
+rh beard
+rh bear
+rh be
+rh ant
+rh ant
+free
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+merge
+free
+option merge 2
+option threads 2
+option descend 0
+new
+it gerbil
+it ant
+it fox
+sort
+new
+it be
+it bear
+sort
+new
+new
+it zebra
+it ant
+it beard
+sort
+new
+it fox
+sort
+merge
+rh ant
+rh ant
+rh be
+rh bear
+rh beard
+rh fox
+rh fox
+rh gerbil
+rh zebra
+free
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+merge
+free
+option descend 1
+new
+it gerbil
+it ant
+it fox
+sort
+new
+it be
+it bear
+sort
+new
+new
+it zebra
+it ant
+it beard
+sort
+new
+it fox
+sort
+merge
+rh zebra
+rh gerbil
+rh fox
+rh fox
+rh beard
+rh bear
+rh be
+rh ant
+rh ant
+free
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+new
+ih RAND 500
+sort
+merge
+free
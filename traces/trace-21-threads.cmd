@@ -0,0 +1,16 @@
+# Test of allocating and freeing strings from several threads, with and
+# without allocation failures
+option fail 0
+option malloc 0
+mpstr 20000 1
+mpstr 20000 4
+option malloc 10
+mpstr 20000 1
+mpstr 20000 4
+option malloc 50
+mpstr 20000 8
+option malloc 0
+new
+ih RAND 100
+mpstr 20000 4
+free
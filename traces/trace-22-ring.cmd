@@ -0,0 +1,5 @@
+# Test if time complexity of deque_insert_head, deque_insert_tail,
+# deque_remove_head, and deque_remove_tail is constant
+option simulation 1
+ring
+option simulation 0
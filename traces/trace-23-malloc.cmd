@@ -0,0 +1,12 @@
+# Test of malloc failure on repeated insert_head and insert_tail of strings
+# too long to be stored in the elements, which fail one by one
+option fail 100
+option malloc 0
+new
+option malloc 25
+ih abcdefghijklmnopqrstuvwxyz0123456789 40
+it abcdefghijklmnopqrstuvwxyz0123456789 40
+ih RAND 40
+option malloc 0
+size
+free
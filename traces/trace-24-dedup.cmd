@@ -0,0 +1,44 @@
+# Test of delete_duplicate through a hash table, on unsorted queues with
+# duplicates anywhere, compared with sorting and removing runs first
+option fail 0
+option malloc 0
+option dedup 1
+new
+it bear
+it gerbil
+it bear
+it dolphin
+it gerbil
+it meerkat
+it bear
+it abcdefghijklmnopqrstuvwxyz0123456789
+it abcdefghijklmnopqrstuvwxyz0123456
+it abcdefghijklmnopqrstuvwxyz0123456789
+dedup
+rh dolphin
+rh meerkat
+rh abcdefghijklmnopqrstuvwxyz0123456
+size
+dedup
+size
+ih RAND 2000
+ih dup 3
+it dup
+it RAND 2000
+dedup
+free
+option dedup 0
+new
+it bear
+it gerbil
+it bear
+it dolphin
+it gerbil
+it meerkat
+it bear
+sort
+dedup
+rh dolphin
+rh meerkat
+size
+free
@@ -0,0 +1,44 @@
+# Test of move_head, move_tail and move_range between two queues, and within
+# one queue, including counts clamped to the size of the queue
+option fail 0
+option malloc 0
+new
+new
+it a
+it b
+it c
+it d
+it e
+it f
+it g
+it h
+mh 0 2
+mt 0 2
+mr 0 1 3
+mh 0 0
+mr 0 2 1
+mt 0 5
+size
+prev
+mr 1 2 6
+mr 0 1 3
+rh a
+rh f
+rh b
+rh c
+size
+ih RAND 1000
+mr 1 100 900
+mh 1 50
+mt 1 50
+mr 0 10 20
+size
+next
+rh g
+rh h
+rh d
+rh e
+mh 0 1000
+size
+free
+free
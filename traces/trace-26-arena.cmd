@@ -0,0 +1,59 @@
+# Test of the allocator carving blocks out of per-size-class slabs, with the
+# same operations and results as the default allocator, and blocks freed
+# after the allocator is switched
+option fail 100
+option malloc 0
+option arena 0
+new
+it a-string-too-long-to-be-stored-inline
+ih short
+it another-string-of-a-different-size-class-which-is-much-longer-than-the-first-one
+ih a-string-too-long-to-be-stored-inline-too
+it tiny
+rh a-string-too-long-to-be-stored-inline-too
+rt tiny
+rh short
+rt another-string-of-a-different-size-class-which-is-much-longer-than-the-first-one
+it a-string-too-long-to-be-stored-inline 200
+ih RAND 300
+sort
+reverse
+option malloc 25
+ih abcdefghijklmnopqrstuvwxyz0123456789 40
+option malloc 0
+size
+dedup
+size
+free
+option arena 1
+new
+it a-string-too-long-to-be-stored-inline
+ih short
+it another-string-of-a-different-size-class-which-is-much-longer-than-the-first-one
+ih a-string-too-long-to-be-stored-inline-too
+it tiny
+rh a-string-too-long-to-be-stored-inline-too
+rt tiny
+rh short
+rt another-string-of-a-different-size-class-which-is-much-longer-than-the-first-one
+it a-string-too-long-to-be-stored-inline 200
+ih RAND 300
+sort
+reverse
+option malloc 25
+ih abcdefghijklmnopqrstuvwxyz0123456789 40
+option malloc 0
+size
+dedup
+size
+free
+option arena 1
+new
+it a-string-too-long-to-be-stored-inline 100
+option arena 0
+it a-string-too-long-to-be-stored-inline 100
+option arena 1
+rh a-string-too-long-to-be-stored-inline
+size
+free
+option arena 0
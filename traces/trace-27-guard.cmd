@@ -0,0 +1,40 @@
+# Test of blocks placed right in front of inaccessible pages: writing one
+# byte past any of them faults, and queue operations give the same results
+# as with the default allocator
+option fail 0
+option malloc 0
+option guard 0
+new
+it a-string-too-long-to-be-stored-inline
+ih short
+it another-string-too-long-to-be-stored-inline-of-odd-size
+ih x
+rh x
+rt another-string-too-long-to-be-stored-inline-of-odd-size
+rh short
+it abcdefghijklmnopqrstuvwxyz0123456789 50
+ih RAND 200
+sort
+reverse
+dedup
+size
+free
+option guard 1
+new
+it a-string-too-long-to-be-stored-inline
+ih short
+it another-string-too-long-to-be-stored-inline-of-odd-size
+ih x
+rh x
+rt another-string-too-long-to-be-stored-inline-of-odd-size
+rh short
+it abcdefghijklmnopqrstuvwxyz0123456789 50
+ih RAND 200
+sort
+reverse
+dedup
+size
+free
+option guard 1
+overrun 64
+option guard 0
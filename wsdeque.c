@@ -0,0 +1,111 @@
+#include "wsdeque.h"
+#include <stdlib.h>
+
+#include "harness.h"
+
+/* Create an empty deque */
+wsdeque_t *wsdeque_new(size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    wsdeque_t *d = malloc(sizeof(wsdeque_t));
+    if (d == NULL) {
+        return NULL;
+    }
+
+    d->slots = malloc(sizeof(*d->slots) * size);
+    if (d->slots == NULL) {
+        free(d);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        atomic_init(&d->slots[i], NULL);
+    }
+    atomic_init(&d->top, 0);
+    atomic_init(&d->bottom, 0);
+    d->mask = size - 1;
+    return d;
+}
+
+/* Free all storage used by deque */
+void wsdeque_free(wsdeque_t *d)
+{
+    if (d == NULL) {
+        return;
+    }
+
+    free(d->slots);
+    free(d);
+}
+
+/* Push an item at the bottom, called by the owner only */
+bool wsdeque_push(wsdeque_t *d, void *item)
+{
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    if (b - t > d->mask) {
+        return false;
+    }
+
+    atomic_store_explicit(&d->slots[b & d->mask], item, memory_order_relaxed);
+    /* Publish the item before the new bottom */
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    return true;
+}
+
+/* Pop the item at the bottom, called by the owner only */
+void *wsdeque_pop(wsdeque_t *d)
+{
+    /* Reserve the bottom item before looking at top, so a thief either sees
+     * the reservation or is seen by the owner */
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (t > b) {
+        /* Empty */
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    void *item =
+        atomic_load_explicit(&d->slots[b & d->mask], memory_order_relaxed);
+    if (t == b) {
+        /* The last item, race the thieves for it */
+        if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                     memory_order_seq_cst,
+                                                     memory_order_relaxed)) {
+            item = NULL;
+        }
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+
+    return item;
+}
+
+/* Steal the item at the top, from any thread */
+void *wsdeque_steal(wsdeque_t *d)
+{
+    long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+    if (t >= b) {
+        return NULL;
+    }
+
+    void *item =
+        atomic_load_explicit(&d->slots[t & d->mask], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return NULL;
+    }
+
+    return item;
+}
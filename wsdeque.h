@@ -0,0 +1,82 @@
+#ifndef LAB0_WSDEQUE_H
+#define LAB0_WSDEQUE_H
+
+/* This program implements a bounded work-stealing deque after Chase and Lev.
+ *
+ * The owner thread pushes and pops items at the bottom, like q_insert_head()
+ * and q_remove_head() on a queue, while any number of thief threads steal
+ * items from the top, like q_remove_tail(). The owner only synchronizes with
+ * thieves when a single item is left, so it mostly runs uncontended.
+ *
+ * Reference:
+ * N. M. Lê et al., "Correct and Efficient Work-Stealing for Weak Memory
+ * Models", PPoPP 2013
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cacheline.h"
+
+/**
+ * wsdeque_t - Work-stealing deque
+ * @top: index of the next item to steal, advanced by thieves and the owner
+ * @bottom: index of the next item to push, written by the owner only
+ * @mask: the number of slots minus one
+ * @slots: the ring of items
+ *
+ * The items between @top and @bottom are in the deque. Indices are signed,
+ * since the owner may briefly decrement @bottom below @top while popping.
+ */
+typedef struct {
+    atomic_long top;
+    char pad_top[CACHE_LINE_SIZE];
+    atomic_long bottom;
+    char pad_bottom[CACHE_LINE_SIZE];
+    long mask;
+    _Atomic(void *) *slots;
+} wsdeque_t;
+
+/**
+ * wsdeque_new() - Create an empty deque
+ * @capacity: the least number of items the deque must hold, rounded up to a
+ * power of two
+ *
+ * Return: NULL for allocation failed
+ */
+wsdeque_t *wsdeque_new(size_t capacity);
+
+/**
+ * wsdeque_free() - Free all storage used by deque, no effect if @d is NULL
+ * @d: the deque, which no thread may be using any more
+ */
+void wsdeque_free(wsdeque_t *d);
+
+/**
+ * wsdeque_push() - Push an item at the bottom, called by the owner only
+ * @d: the deque
+ * @item: the item, which must not be NULL
+ *
+ * Return: true for success, false if the deque is full
+ */
+bool wsdeque_push(wsdeque_t *d, void *item);
+
+/**
+ * wsdeque_pop() - Pop the item at the bottom, called by the owner only
+ * @d: the deque
+ *
+ * Return: the item, NULL if the deque is empty or a thief stole the last one
+ */
+void *wsdeque_pop(wsdeque_t *d);
+
+/**
+ * wsdeque_steal() - Steal the item at the top, from any thread
+ * @d: the deque
+ *
+ * Return: the item, NULL if the deque is empty or another thread took the item
+ * first, in which case stealing may be tried again
+ */
+void *wsdeque_steal(wsdeque_t *d);
+
+#endif /* LAB0_WSDEQUE_H */